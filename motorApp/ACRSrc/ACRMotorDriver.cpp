@@ -49,6 +49,9 @@ ACRController::ACRController(const char *portName, const char *ACRPortName, int
 
   binaryInReg_  = 4096;
   binaryOutReg_ = 4097;
+  blockRead_    = true;
+  blockReadFailures_ = 0;
+  blockReadHoldoff_  = 0;
   
   // Create controller-specific parameters
   createParam(ACRJerkString,         asynParamFloat64,       &ACRJerk_);
@@ -113,6 +116,7 @@ void ACRController::report(FILE *fp, int level)
   if (level > 0) {
     fprintf(fp, "  binary input = 0x%x\n", binaryIn_);
     fprintf(fp, "  binary output readback = 0x%x\n", binaryOutRBV_);
+    fprintf(fp, "  block reads = %s\n", !blockRead_ ? "off" : blockReadHoldoff_ ? "suspended" : "on");
   }
 
 
@@ -274,6 +278,108 @@ asynStatus ACRController::readBinaryIO()
   return status;
 }
 
+/** Polls a set of axes.
+  * Reads the status registers of all the axes with readStatusRegs() and then calls
+  * asynMotorController::pollAll(), so that ACRAxis::poll() uses the values that were read.
+  * If the block read fails ACRAxis::poll() reads the registers of each axis itself.  After
+  * ACR_BLOCK_READ_MAX_FAILURES failures in a row block reads are suspended until
+  * ACR_BLOCK_READ_RETRY_POLLS polls have succeeded, then they are tried again.
+  * \param[in] pAxes Array of pointers to the axes to poll; entries may be NULL.
+  * \param[in] numAxes Number of entries in pAxes.
+  * \param[out] moving Moving flag of each axis. */
+asynStatus ACRController::pollAll(asynMotorAxis **pAxes, int numAxes, bool *moving)
+{
+  int i;
+  asynStatus status;
+  static const char *functionName = "pollAll";
+
+  if (blockRead_ && (blockReadHoldoff_ == 0)) {
+    status = readStatusRegs((ACRAxis **)pAxes, numAxes);
+    if (status == asynSuccess) {
+      blockReadFailures_ = 0;
+    } else if (blockRead_ && (++blockReadFailures_ >= ACR_BLOCK_READ_MAX_FAILURES)) {
+      asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+        "%s:%s: %d block reads failed, reading registers individually for %d polls\n",
+        driverName, functionName, blockReadFailures_, ACR_BLOCK_READ_RETRY_POLLS);
+      blockReadFailures_ = 0;
+      blockReadHoldoff_ = ACR_BLOCK_READ_RETRY_POLLS;
+    }
+  }
+  status = asynMotorController::pollAll(pAxes, numAxes, moving);
+  if ((blockReadHoldoff_ > 0) && (status == asynSuccess)) blockReadHoldoff_--;
+  for (i=0; i<numAxes; i++) {
+    if (pAxes[i]) ((ACRAxis *)pAxes[i])->statusValid_ = false;
+  }
+  return status;
+}
+
+/** Reads the encoder position, theoretical position, flags and limits registers of a set of axes.
+  * The registers of up to ACR_BLOCK_READ_AXES axes are read with a single PRINT command, e.g.
+  * "?P12290,P12294,P4120,P4600,P12546,...", and cached in each ACRAxis.
+  * A communication error is left to pollAll() to retry.  If the controller replies but the
+  * reply does not contain the expected number of values, the controller does not accept
+  * the block read, and the single register queries in ACRAxis::poll() are used from then on.
+  * \param[in] pAxes Array of pointers to the axes to read; entries may be NULL.
+  * \param[in] numAxes Number of entries in pAxes. */
+asynStatus ACRController::readStatusRegs(ACRAxis **pAxes, int numAxes)
+{
+  char output[MAX_CONTROLLER_STRING_SIZE];
+  char input[1024];
+  ACRAxis *pReadAxes[ACR_BLOCK_READ_AXES];
+  int first = 0;
+  size_t nread;
+  asynStatus status = asynSuccess;
+  static const char *functionName = "readStatusRegs";
+
+  while (first < numAxes) {
+    int i, numRead = 0;
+    char *ptr = output;
+
+    ptr += sprintf(ptr, "?");
+    for (i=first; i<numAxes && numRead<ACR_BLOCK_READ_AXES; i++) {
+      ACRAxis *pAxis = pAxes[i];
+      if (!pAxis) continue;
+      ptr += sprintf(ptr, "%sP%d,P%d,P%d,P%d", numRead ? "," : "",
+                     pAxis->encoderPositionReg_, pAxis->theoryPositionReg_,
+                     pAxis->flagsReg_, pAxis->limitsReg_);
+      pReadAxes[numRead++] = pAxis;
+    }
+    first = i;
+    if (numRead == 0) break;
+
+    status = writeReadController(output, input, sizeof(input), &nread, DEFAULT_CONTROLLER_TIMEOUT);
+    if (status) break;
+
+    double values[ACR_BLOCK_READ_AXES*ACR_STATUS_REGS];
+    int numValues = 0;
+    char *pValue = input, *pEnd;
+    while (numValues < numRead*ACR_STATUS_REGS) {
+      pValue += strspn(pValue, " \t,\r\n");
+      values[numValues] = strtod(pValue, &pEnd);
+      if (pEnd == pValue) break;
+      numValues++;
+      pValue = pEnd;
+    }
+    if (numValues != numRead*ACR_STATUS_REGS) {
+      asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+        "%s:%s: unexpected reply \"%s\" to \"%s\", controller does not accept block reads, reading registers individually\n",
+        driverName, functionName, input, output);
+      blockRead_ = false;
+      status = asynError;
+      break;
+    }
+    for (i=0; i<numRead; i++) {
+      ACRAxis *pAxis = pReadAxes[i];
+      pAxis->encoderPosition_ = values[i*ACR_STATUS_REGS];
+      pAxis->theoryPosition_  = values[i*ACR_STATUS_REGS + 1];
+      pAxis->currentFlags_    = (int)values[i*ACR_STATUS_REGS + 2];
+      pAxis->currentLimits_   = (int)values[i*ACR_STATUS_REGS + 3];
+      pAxis->statusValid_     = true;
+    }
+  }
+  return status;
+}
+
 // These are the ACRAxis methods
 
 /** Creates a new ACRAxis object.
@@ -284,7 +390,8 @@ asynStatus ACRController::readBinaryIO()
   */
 ACRAxis::ACRAxis(ACRController *pC, int axisNo)
   : asynMotorAxis(pC, axisNo),
-    pC_(pC)
+    pC_(pC),
+    statusValid_(false)
 {
   asynStatus status;
   
@@ -429,36 +536,20 @@ asynStatus ACRAxis::poll(bool *moving)
   int done;
   int driveOn;
   int limit;
-  asynStatus comStatus;
+  asynStatus comStatus = asynSuccess;
 
-  // Read the current encoder position
-  sprintf(pC_->outString_, "?P%d", encoderPositionReg_);
-  comStatus = pC_->writeReadController();
+  // Read the registers unless ACRController::readStatusRegs() has already read them
+  if (!statusValid_) comStatus = readStatusRegs();
+  statusValid_ = false;
   if (comStatus) goto skip;
-  encoderPosition_ = atof(pC_->inString_);
-  setDoubleParam(pC_->motorEncoderPosition_,encoderPosition_);
 
-  // Read the current theoretical position
-  sprintf(pC_->outString_, "?P%d", theoryPositionReg_);
-  comStatus = pC_->writeReadController();
-  if (comStatus) goto skip;
-  theoryPosition_ = atof(pC_->inString_);
+  setDoubleParam(pC_->motorEncoderPosition_,encoderPosition_);
   setDoubleParam(pC_->motorPosition_, theoryPosition_);
 
-  // Read the current flags
-  sprintf(pC_->outString_, "?P%d", flagsReg_);
-  comStatus = pC_->writeReadController();
-  if (comStatus) goto skip;
-  currentFlags_ = atoi(pC_->inString_);
   done = (currentFlags_ & 0x1000000)?0:1;
   setIntegerParam(pC_->motorStatusDone_, done);
   *moving = done ? false:true;
 
-  // Read the current limit status
-  sprintf(pC_->outString_, "?P%d", limitsReg_);
-  comStatus = pC_->writeReadController();
-  if (comStatus) goto skip;
-  currentLimits_ = atoi(pC_->inString_);
   limit = (currentLimits_ & 0x1)?1:0;
   setIntegerParam(pC_->motorStatusHighLimit_, limit);
   limit = (currentLimits_ & 0x2)?1:0;
@@ -480,6 +571,39 @@ asynStatus ACRAxis::poll(bool *moving)
   return comStatus ? asynError : asynSuccess;
 }
 
+/** Reads the encoder position, theoretical position, flags and limits registers of this axis
+  * with one query per register. */
+asynStatus ACRAxis::readStatusRegs()
+{
+  asynStatus comStatus;
+
+  // Read the current encoder position
+  sprintf(pC_->outString_, "?P%d", encoderPositionReg_);
+  comStatus = pC_->writeReadController();
+  if (comStatus) return comStatus;
+  encoderPosition_ = atof(pC_->inString_);
+
+  // Read the current theoretical position
+  sprintf(pC_->outString_, "?P%d", theoryPositionReg_);
+  comStatus = pC_->writeReadController();
+  if (comStatus) return comStatus;
+  theoryPosition_ = atof(pC_->inString_);
+
+  // Read the current flags
+  sprintf(pC_->outString_, "?P%d", flagsReg_);
+  comStatus = pC_->writeReadController();
+  if (comStatus) return comStatus;
+  currentFlags_ = atoi(pC_->inString_);
+
+  // Read the current limit status
+  sprintf(pC_->outString_, "?P%d", limitsReg_);
+  comStatus = pC_->writeReadController();
+  if (comStatus) return comStatus;
+  currentLimits_ = atoi(pC_->inString_);
+
+  return comStatus;
+}
+
 /** Code for iocsh registration */
 static const iocshArg ACRCreateControllerArg0 = {"Port name", iocshArgString};
 static const iocshArg ACRCreateControllerArg1 = {"ACR port name", iocshArgString};
@@ -17,6 +17,13 @@ March 28, 2011
 #define ACRBinaryOutString      "ACR_BINARY_OUT"
 #define ACRBinaryOutRBVString   "ACR_BINARY_OUT_RBV"
 
+/** Number of status registers read per axis, and maximum number of axes read with one PRINT command */
+#define ACR_STATUS_REGS         4
+#define ACR_BLOCK_READ_AXES     4
+/** Consecutive failed block reads before they are suspended, and clean polls before they are retried */
+#define ACR_BLOCK_READ_MAX_FAILURES 3
+#define ACR_BLOCK_READ_RETRY_POLLS  100
+
 class epicsShareClass ACRAxis : public asynMotorAxis
 {
 public:
@@ -32,6 +39,8 @@ public:
   asynStatus setClosedLoop(bool closedLoop);
 
 private:
+  asynStatus readStatusRegs();
+
   ACRController *pC_;      /**< Pointer to the asynMotorController to which this axis belongs.
                                 *   Abbreviated because it is used very frequently */
   char axisName_[10];      /**< Name of each axis, used in commands to ACR controller */ 
@@ -44,6 +53,7 @@ private:
   double theoryPosition_;  /**< Cached copy of the theoretical position */ 
   int currentFlags_;       /**< Cached copy of the current flags */ 
   int currentLimits_;      /**< Cached copy of the current limits */ 
+  bool statusValid_;       /**< The cached registers were read by ACRController::readStatusRegs() for this poll */
   
 friend class ACRController;
 };
@@ -61,10 +71,12 @@ public:
   void report(FILE *fp, int level);
   ACRAxis* getAxis(asynUser *pasynUser);
   ACRAxis* getAxis(int axisNo);
+  asynStatus pollAll(asynMotorAxis **pAxes, int numAxes, bool *moving);
 
   
   /* These are the methods that are new to this class */
   asynStatus readBinaryIO();
+  asynStatus readStatusRegs(ACRAxis **pAxes, int numAxes);
   
 protected:
   int ACRJerk_;          /**< Jerk time parameter index */        
@@ -82,6 +94,9 @@ private:
   int binaryOutRBV_;
   int binaryInReg_;
   int binaryOutReg_;
+  bool blockRead_;       /**< Read the status registers of several axes with one command */
+  int blockReadFailures_; /**< Consecutive block reads that failed */
+  int blockReadHoldoff_;  /**< Clean polls to do with single register queries before block reads are retried */
   
 friend class ACRAxis;
 };
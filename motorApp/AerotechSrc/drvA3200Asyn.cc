@@ -38,6 +38,8 @@ in file LICENSE that is included with this distribution.
 *                    MoveDone false before the 1st status update.
 *                  - Added axis name to "RAMP RATE" command.
 * .03 10-14-15 rls - Use "ReverseDirec" parameter to set "HomeSetup" parameter.
+* .04 10-16-26     - Poller reads all axes with one "~STATUS" request before taking the axis
+*                    mutexes, which are then held only to publish the results.
 */
 
 #include <stddef.h>
@@ -81,6 +83,10 @@ in file LICENSE that is included with this distribution.
 #define DRIVER_NAME "drvA3200Asyn"
 #define BUFFER_SIZE 4096 /* Size of input and output buffers */
 #define TIMEOUT 2.0     /* Timeout for I/O in seconds */
+#define STATUS_REQUEST_PER_AXIS 128 /* Length of the "~STATUS" items of one axis, excluding the axis names */
+#define STATUS_REPLY_PER_AXIS   160 /* Longest reply to the "~STATUS" items of one axis */
+#define COMBINED_MAX_FAILURES 3   /* Consecutive failed combined requests before they are suspended */
+#define COMBINED_RETRY_POLLS  100 /* Clean polls done one axis at a time before combined requests are retried */
 
 /* The following should be defined to have the same value as
 the A3200 parameters specified */
@@ -150,8 +156,23 @@ typedef struct
     epicsEventId pollEventId;
     epicsMutexId sendReceiveMutex;
     AXIS_HDL pAxis;  /* array of axes */
+    bool combinedStatus;  /* Read the status of several axes with one "~STATUS" request */
+    int combinedFailures; /* Consecutive combined requests that failed */
+    int combinedHoldoff;  /* Clean polls to do one axis at a time before combined requests are retried */
 } A3200Controller;
 
+/* Status items of one axis, read by the poller */
+typedef struct
+{
+    bool ok;
+    int axis_status;
+    int drive_status;
+    int axis_fault;
+    double pfbk;
+    double pcmd;
+    double vfbk;
+} A3200AxisStatus;
+
 typedef struct motorAxisHandle
 {
     A3200Controller *pController;
@@ -213,6 +234,11 @@ static void motorAxisReport(int level)
         {
             printf("    moving poll period: %f\n", pA3200Controller[i].movingPollPeriod);
             printf("    idle poll period: %f\n", pA3200Controller[i].idlePollPeriod);
+            printf("    status request: %s\n",
+                   (pA3200Controller[i].combinedStatus && pA3200Controller[i].combinedHoldoff == 0) ?
+                   "combined" : "one axis at a time");
+            if (pA3200Controller[i].combinedStatus && pA3200Controller[i].combinedHoldoff > 0)
+                printf("    combined request retried after %d clean polls\n", pA3200Controller[i].combinedHoldoff);
         }
         for (j = 0; j < pA3200Controller[i].numAxes; j++)
         {
@@ -671,6 +697,144 @@ static int motorAxisforceCallback(AXIS_HDL pAxis)
     return MOTOR_AXIS_OK;
 }
 
+/* Parses the values of one axis from a "~STATUS" reply.
+ * Returns a pointer to the rest of the reply, or NULL if the reply is too short. */
+static const char *A3200ParseStatus(const char *pReply, A3200AxisStatus *pStatus)
+{
+    char *pEnd;
+
+    pStatus->axis_status = (int) strtol(pReply, &pEnd, 10);
+    if (pEnd == pReply) return NULL;
+    pStatus->drive_status = (int) strtol(pReply = pEnd, &pEnd, 10);
+    if (pEnd == pReply) return NULL;
+    pStatus->axis_fault = (int) strtol(pReply = pEnd, &pEnd, 10);
+    if (pEnd == pReply) return NULL;
+    pStatus->pfbk = strtod(pReply = pEnd, &pEnd);
+    if (pEnd == pReply) return NULL;
+    pStatus->pcmd = strtod(pReply = pEnd, &pEnd);
+    if (pEnd == pReply) return NULL;
+    pStatus->vfbk = strtod(pReply = pEnd, &pEnd);
+    if (pEnd == pReply) return NULL;
+    return pEnd;
+}
+
+/* Counts a failed combined "~STATUS" request.  After COMBINED_MAX_FAILURES in a row
+ * the poller reads one axis per request for COMBINED_RETRY_POLLS clean polls. */
+static void A3200CombinedFailed(A3200Controller *pController)
+{
+    if (++pController->combinedFailures < COMBINED_MAX_FAILURES)
+        return;
+    PRINT(pController->pAxis->logParam, TERROR,
+          "A3200Poller: %d combined status requests failed, reading one axis per request for %d polls\n",
+          pController->combinedFailures, COMBINED_RETRY_POLLS);
+    pController->combinedFailures = 0;
+    pController->combinedHoldoff = COMBINED_RETRY_POLLS;
+}
+
+/* Reads the status of all axes.
+ * The six status items of as many axes as fit in one request are read with a single
+ * "~STATUS" command.  If a combined request fails, the axes it covered are read one
+ * per request for that poll.  After COMBINED_MAX_FAILURES such failures in a row the
+ * axes are read one per request until COMBINED_RETRY_POLLS polls have succeeded, then
+ * combined requests are tried again.  Combined requests are only turned off for good if
+ * the controller NAKs one and then accepts each of its axes on its own. */
+static void A3200PollQuery(A3200Controller *pController, A3200AxisStatus *axisStatus)
+{
+    char inputBuff[BUFFER_SIZE], outputBuff[BUFFER_SIZE];
+    const char* STATUS_FORMAT_STRING = "(%s, AxisStatus) (%s, DriveStatus) (%s, AxisFault) (%s, ProgramPositionFeedback) (%s, ProgramPositionCommand) (%s, ProgramVelocityFeedback)";
+    const char *pReply;
+    AXIS_HDL pAxis;
+    int first, next, itera;
+    size_t len;
+    int status;
+    int nakEnd = 0;
+    bool combined, nakAccepted = false, allOK = true;
+
+    for (itera = 0; itera < pController->numAxes; itera++)
+        axisStatus[itera].ok = false;
+    combined = (pController->combinedStatus == true && pController->combinedHoldoff == 0);
+
+    for (first = 0; first < pController->numAxes; first = next)
+    {
+        if (!pController->pAxis[first].mutexId)
+            break;
+        len = sprintf(outputBuff, "~STATUS");
+        for (next = first; next < pController->numAxes; next++)
+        {
+            pAxis = &pController->pAxis[next];
+            if (!pAxis->mutexId)
+                break;
+            if (next > first && (combined == false ||
+                                 len + 6 * strlen(pAxis->axisName) + STATUS_REQUEST_PER_AXIS >= BUFFER_SIZE ||
+                                 (next - first + 1) * STATUS_REPLY_PER_AXIS >= BUFFER_SIZE))
+                break;
+            len += sprintf(&outputBuff[len], " ");
+            len += sprintf(&outputBuff[len], STATUS_FORMAT_STRING,
+                           pAxis->axisName,
+                           pAxis->axisName,
+                           pAxis->axisName,
+                           pAxis->axisName,
+                           pAxis->axisName,
+                           pAxis->axisName);
+        }
+
+        status = sendAndReceive(pController, outputBuff, inputBuff, sizeof(inputBuff));
+        pReply = (status == asynSuccess && inputBuff[0] == ASCII_ACK_CHAR) ? &inputBuff[1] : NULL;
+        for (itera = first; itera < next && pReply; itera++)
+        {
+            pReply = A3200ParseStatus(pReply, &axisStatus[itera]);
+            axisStatus[itera].ok = (pReply != NULL);
+        }
+        if (next - first > 1)
+        {
+            if (pReply != NULL)
+            {
+                pController->combinedFailures = 0;
+                continue;
+            }
+            /* Read the axes of the failed request one per request for the rest of this poll */
+            for (itera = first; itera < next; itera++)
+                axisStatus[itera].ok = false;
+            if (status == asynSuccess && inputBuff[0] == ASCII_NAK_CHAR)
+            {
+                /* Tell a bad axis from a controller that does not accept combined requests */
+                nakEnd = next;
+                nakAccepted = true;
+            }
+            else
+                A3200CombinedFailed(pController);
+            combined = false;
+            next = first;
+        }
+        else if (next <= nakEnd)
+        {
+            if (status != asynSuccess || inputBuff[0] != ASCII_ACK_CHAR)
+                nakAccepted = false;
+            if (next < nakEnd)
+                continue;
+            nakEnd = 0;
+            if (nakAccepted)
+            {
+                PRINT(pController->pAxis->logParam, TERROR,
+                      "A3200Poller: controller rejects combined status requests, reading one axis per request\n");
+                pController->combinedStatus = false;
+            }
+            else
+                A3200CombinedFailed(pController);
+        }
+    }
+
+    /* Count down the clean polls before combined requests are retried */
+    if (pController->combinedHoldoff > 0)
+    {
+        for (itera = 0; itera < pController->numAxes && pController->pAxis[itera].mutexId; itera++)
+            if (!axisStatus[itera].ok)
+                allOK = false;
+        if (allOK)
+            pController->combinedHoldoff--;
+    }
+}
+
 static void A3200Poller(A3200Controller *pController)
 {
     /* This is the task that polls the A3200 */
@@ -678,12 +842,11 @@ static void A3200Poller(A3200Controller *pController)
     AXIS_HDL pAxis;
     int itera;
     bool anyMoving;
-    char inputBuff[BUFFER_SIZE], outputBuff[BUFFER_SIZE];
-    const char* STATUS_FORMAT_STRING = "~STATUS (%s, AxisStatus) (%s, DriveStatus) (%s, AxisFault) (%s, ProgramPositionFeedback) (%s, ProgramPositionCommand) (%s, ProgramVelocityFeedback)";
     int status;
     int axis_status, drive_status, axis_fault;
     double pfbk, pcmd, vfbk;
     bool move_active;
+    A3200AxisStatus axisStatus[A3200_MAX_AXES];
 
     timeout = pController->idlePollPeriod;
     epicsEventSignal(pController->pollEventId);  /* Force on poll at startup */
@@ -697,6 +860,9 @@ static void A3200Poller(A3200Controller *pController)
 
         anyMoving = false;
 
+        /* Read everything first, the axis mutexes are only held to publish the results */
+        A3200PollQuery(pController, axisStatus);
+
         for (itera = 0; itera < pController->numAxes; itera++)
         {
             PARAMS params;
@@ -707,23 +873,19 @@ static void A3200Poller(A3200Controller *pController)
             if (!pAxis->mutexId)
                 break;
             epicsMutexLock(pAxis->mutexId);
-            sprintf(outputBuff, STATUS_FORMAT_STRING,
-                    pAxis->axisName,
-                    pAxis->axisName,
-                    pAxis->axisName,
-                    pAxis->axisName,
-                    pAxis->axisName,
-                    pAxis->axisName);
-
-            status = sendAndReceive(pController, outputBuff, inputBuff, sizeof(inputBuff));
-            if (status != asynSuccess || inputBuff[0] != ASCII_ACK_CHAR)
+            if (!axisStatus[itera].ok)
             {
                 motorParam->setInteger(pAxis->params, motorAxisCommError, 1);
                 epicsMutexUnlock(pAxis->mutexId);
                 continue;
             }
 
-            sscanf(&inputBuff[1], "%d %d %d %lf %lf %lf", &axis_status, &drive_status, &axis_fault, &pfbk, &pcmd, &vfbk);
+            axis_status  = axisStatus[itera].axis_status;
+            drive_status = axisStatus[itera].drive_status;
+            axis_fault   = axisStatus[itera].axis_fault;
+            pfbk = axisStatus[itera].pfbk;
+            pcmd = axisStatus[itera].pcmd;
+            vfbk = axisStatus[itera].vfbk;
 
             motorParam->setInteger(params, motorAxisCommError, 0);
 
@@ -840,6 +1002,9 @@ int A3200AsynConfig(int card,             /* Controller number */
     pController->numAxes = numAxes;
     pController->movingPollPeriod = movingPollPeriod / 1000.;
     pController->idlePollPeriod = idlePollPeriod / 1000.;
+    pController->combinedStatus = true;
+    pController->combinedFailures = 0;
+    pController->combinedHoldoff = 0;
 
     pController->sendReceiveMutex = epicsMutexMustCreate();
 
@@ -65,6 +65,9 @@ in file LICENSE that is included with this distribution.
 * .20 11-24-14 rls - Moved "WAIT MODE NOWAIT" from EnsembleAsynConfig to motorAxisSetInteger 
 *                    where torque is enabled/disabled. 
 * .21 10-14-15 rls - Use "ReverseDirec" parameter to set "HomeSetup" parameter.
+* .22 10-16-26     - Poller reads all axes first, with all status queries written as one
+*                    pipelined request, then publishes each axis under its mutex.
+*                    PLANESTATUS is read once per poll instead of once per axis.
 */
 
 
@@ -132,8 +135,13 @@ typedef struct
     epicsEventId pollEventId;
     epicsMutexId sendReceiveMutex;
     AXIS_HDL pAxis;  /* array of axes */
+    bool pipelinePoll;   /* Send all poller queries in one request */
+    int pipelineFailures; /* Consecutive pipelined polls that failed */
+    int pipelineHoldoff;  /* Clean polls to do one query at a time before pipelining is retried */
+    int numPollQueries;
 } EnsembleController;
 
+
 typedef struct motorAxisHandle
 {
     EnsembleController *pController;
@@ -177,6 +185,27 @@ static asynStatus sendAndReceive(EnsembleController *, char *, char *, int);
 #define BUFFER_SIZE 100 /* Size of input and output buffers */
 #define TIMEOUT 2.0     /* Timeout for I/O in seconds */
 
+/* Poller queries: PLANESTATUS once, then these per axis */
+#define POLL_AXISSTATUS 0
+#define POLL_PFBKPROG   1
+#define POLL_PCMDPROG   2
+#define POLL_AXISFAULT  3
+#define POLL_VFBK       4
+#define POLL_QUERIES_PER_AXIS 5
+#define POLL_MAX_QUERIES (1 + POLL_QUERIES_PER_AXIS * ENSEMBLE_MAX_AXES)
+#define POLL_BUFFER_SIZE (POLL_MAX_QUERIES * 16) /* Longest query is "AXISSTATUS(@9)\n" */
+#define PIPELINE_MAX_FAILURES 3   /* Consecutive failed pipelined polls before pipelining is suspended */
+#define PIPELINE_RETRY_POLLS  100 /* Clean polls done one query at a time before pipelining is retried */
+
+/* One poller query reply */
+typedef struct
+{
+    asynStatus status;
+    char reply[BUFFER_SIZE];
+} EnsemblePollReply;
+
+static asynStatus sendAndReceiveMulti(EnsembleController *, char *, EnsemblePollReply *, int);
+
 
 /* Status byte bits */
 #define ENABLED_BIT     0x00000001
@@ -228,6 +257,11 @@ static void motorAxisReport(int level)
         {
             printf("    moving poll period: %f\n", pEnsembleController[i].movingPollPeriod);
             printf("    idle poll period: %f\n", pEnsembleController[i].idlePollPeriod);
+            printf("    status queries per poll: %d, %s\n", pEnsembleController[i].numPollQueries,
+                   (pEnsembleController[i].pipelinePoll && pEnsembleController[i].pipelineHoldoff == 0) ?
+                   "pipelined" : "one at a time");
+            if (pEnsembleController[i].pipelinePoll && pEnsembleController[i].pipelineHoldoff > 0)
+                printf("    pipelining retried after %d clean polls\n", pEnsembleController[i].pipelineHoldoff);
         }
         for (j=0; j<pEnsembleController[i].numAxes; j++)
             motorAxisReportAxis(&pEnsembleController[i].pAxis[j], level);
@@ -659,6 +693,100 @@ static int motorAxisforceCallback(AXIS_HDL pAxis)
 }
 
 
+/* Queries the status of all axes.
+ * When pipelining is enabled all queries are written as one request and the replies
+ * are read back in order, so a poll costs one round trip instead of one per query.
+ * If the replies do not come back the queries are sent one at a time for that poll.
+ * After PIPELINE_MAX_FAILURES such polls in a row the queries are sent one at a time
+ * until PIPELINE_RETRY_POLLS polls have succeeded, then pipelining is tried again.
+ * Pipelining is only turned off for good if the controller NAKs a query in the pipelined
+ * request that it accepts when it is sent on its own. */
+static void EnsemblePollQuery(EnsembleController *pController, EnsemblePollReply *replies)
+{
+    static const char *axisQueries[POLL_QUERIES_PER_AXIS] =
+        {"AXISSTATUS(@%d)", "PFBKPROG(@%d)", "PCMDPROG(@%d)", "AXISFAULT(@%d)", "VFBK(@%d)"};
+    char outputBuff[POLL_BUFFER_SIZE];
+    char *pCmd[POLL_MAX_QUERIES];
+    int itera, query, numQueries = 0;
+    size_t len = 0;
+    asynStatus comStatus;
+    bool rejected, allOK;
+
+    /* PLANESTATUS is the same for every axis, so it is read once per poll */
+    pCmd[numQueries++] = outputBuff;
+    len += sprintf(outputBuff, "PLANESTATUS(0)") + 1;
+    for (itera = 0; itera < pController->numAxes; itera++)
+    {
+        if (!pController->pAxis[itera].mutexId)
+            break;
+        for (query = 0; query < POLL_QUERIES_PER_AXIS; query++)
+        {
+            pCmd[numQueries++] = &outputBuff[len];
+            len += sprintf(&outputBuff[len], axisQueries[query], pController->pAxis[itera].axis) + 1;
+        }
+    }
+    pController->numPollQueries = numQueries;
+
+    if (pController->pipelinePoll == true && pController->pipelineHoldoff == 0)
+    {
+        /* Join the queries with the EOS; writeRead appends the EOS to the last one */
+        for (query = 1; query < numQueries; query++)
+            pCmd[query][-1] = ASCII_EOS_CHAR;
+        comStatus = sendAndReceiveMulti(pController, outputBuff, replies, numQueries);
+        for (query = 1; query < numQueries; query++)
+            pCmd[query][-1] = '\0';
+        if (comStatus == asynSuccess)
+        {
+            /* Resend the queries that were NAKed on their own, to tell a bad query
+             * from a controller that does not accept pipelined input */
+            rejected = false;
+            for (query = 0; query < numQueries; query++)
+            {
+                if (replies[query].reply[0] != ASCII_NAK_CHAR)
+                    continue;
+                replies[query].status = sendAndReceive(pController, pCmd[query], replies[query].reply, BUFFER_SIZE);
+                if (replies[query].status == asynSuccess && replies[query].reply[0] == ASCII_ACK_CHAR)
+                    rejected = true;
+            }
+            pController->pipelineFailures = 0;
+            if (!rejected)
+                return;
+            PRINT(pController->pAxis->logParam, TERROR,
+                  "EnsemblePoller: controller rejects pipelined status queries, sending queries one at a time\n");
+            pController->pipelinePoll = false;
+        }
+        else if (++pController->pipelineFailures >= PIPELINE_MAX_FAILURES)
+        {
+            PRINT(pController->pAxis->logParam, TERROR,
+                  "EnsemblePoller: %d pipelined status queries failed, sending queries one at a time for %d polls\n",
+                  pController->pipelineFailures, PIPELINE_RETRY_POLLS);
+            pController->pipelineFailures = 0;
+            pController->pipelineHoldoff = PIPELINE_RETRY_POLLS;
+        }
+    }
+
+    replies[0].status = sendAndReceive(pController, pCmd[0], replies[0].reply, BUFFER_SIZE);
+    for (query = 1; query < numQueries; query++)
+    {
+        /* Skip the remaining queries of an axis after a communication error */
+        if (((query - 1) % POLL_QUERIES_PER_AXIS) != 0 && replies[query-1].status != asynSuccess)
+            replies[query].status = asynError;
+        else
+            replies[query].status = sendAndReceive(pController, pCmd[query], replies[query].reply, BUFFER_SIZE);
+    }
+
+    /* Count down the clean polls before pipelining is retried */
+    if (pController->pipelineHoldoff > 0)
+    {
+        allOK = true;
+        for (query = 0; query < numQueries; query++)
+            if (replies[query].status != asynSuccess)
+                allOK = false;
+        if (allOK)
+            pController->pipelineHoldoff--;
+    }
+}
+
 static void EnsemblePoller(EnsembleController *pController)
 {
     /* This is the task that polls the Ensemble */
@@ -666,9 +794,11 @@ static void EnsemblePoller(EnsembleController *pController)
     AXIS_HDL pAxis;
     int status, itera, comStatus;
     Axis_Status axisStatus;
-    bool anyMoving;
-    char inputBuff[BUFFER_SIZE], outputBuff[BUFFER_SIZE];
+    bool anyMoving, planeMoving;
+    char *inputBuff;
+    EnsemblePollReply *replies, *axisReplies;
 
+    replies = (EnsemblePollReply *) calloc(POLL_MAX_QUERIES, sizeof(EnsemblePollReply));
     timeout = pController->idlePollPeriod;
     epicsEventSignal(pController->pollEventId);  /* Force on poll at startup */
 
@@ -681,14 +811,19 @@ static void EnsemblePoller(EnsembleController *pController)
 
         anyMoving = false;
 
+        /* Read everything first, the axis mutexes are only held to publish the results */
+        EnsemblePollQuery(pController, replies);
+        planeMoving = (0x01 & atoi(&replies[0].reply[1])) ? true : false;
+
         for (itera = 0; itera < pController->numAxes; itera++)
         {
             pAxis = &pController->pAxis[itera];
             if (!pAxis->mutexId)
                 break;
+            axisReplies = &replies[1 + itera * POLL_QUERIES_PER_AXIS];
             epicsMutexLock(pAxis->mutexId);
-            sprintf(outputBuff, "AXISSTATUS(@%d)", pAxis->axis); 
-            comStatus = sendAndReceive(pController, outputBuff, inputBuff, sizeof(inputBuff));
+            comStatus = axisReplies[POLL_AXISSTATUS].status;
+            inputBuff = axisReplies[POLL_AXISSTATUS].reply;
             if (comStatus != asynSuccess || strlen(inputBuff) <= 1)
             {
                 motorParam->setInteger(pAxis->params, motorAxisCommError, 1);
@@ -712,8 +847,7 @@ static void EnsemblePoller(EnsembleController *pController)
                     motorParam->setInteger(params, motorAxisCommError, 0);
                     axisStatus.All = atoi(&inputBuff[1]);
                     
-                    comStatus = sendAndReceive(pController, (char *) "PLANESTATUS(0)", inputBuff, sizeof(inputBuff));
-                    move_active = (0x01 & atoi(&inputBuff[1])) ? true : false;
+                    move_active = planeMoving;
                     move_active |= axisStatus.Bits.move_active;
                     motorParam->setInteger(params, motorAxisDone, !move_active);
                     if (move_active)
@@ -743,8 +877,8 @@ static void EnsemblePoller(EnsembleController *pController)
                 }
                 pAxis->axisStatus = axisStatus.All;
             }
-            sprintf(outputBuff, "PFBKPROG(@%d)", pAxis->axis);
-            comStatus = sendAndReceive(pController, outputBuff, inputBuff, sizeof(inputBuff));
+            comStatus = axisReplies[POLL_PFBKPROG].status;
+            inputBuff = axisReplies[POLL_PFBKPROG].reply;
             if (comStatus  != asynSuccess)
             {
                 motorParam->setInteger(pAxis->params, motorAxisCommError, 1);
@@ -762,8 +896,7 @@ static void EnsemblePoller(EnsembleController *pController)
                 motorParam->setDouble(pAxis->params, motorAxisEncoderPosn, position);
 
                 /* Read commanded postion. */
-                sprintf(outputBuff, "PCMDPROG(@%d)", pAxis->axis);
-                comStatus = sendAndReceive(pController, outputBuff, inputBuff, sizeof(inputBuff));
+                inputBuff = axisReplies[POLL_PCMDPROG].reply;
                 position = atof(&inputBuff[1]);
                 position /= fabs(pAxis->stepSize);
                 motorParam->setDouble(pAxis->params, motorAxisPosition, position);
@@ -771,8 +904,8 @@ static void EnsemblePoller(EnsembleController *pController)
                 PRINT(pAxis->logParam, IODRIVER, "EnsemblePoller: axis %d axisStatus=%x, position=%f\n", 
                       pAxis->axis, pAxis->axisStatus, pAxis->currentCmdPos);
             }
-            sprintf(outputBuff, "AXISFAULT(@%d)", pAxis->axis);
-            comStatus = sendAndReceive(pController, outputBuff, inputBuff, sizeof(inputBuff));
+            comStatus = axisReplies[POLL_AXISFAULT].status;
+            inputBuff = axisReplies[POLL_AXISFAULT].reply;
             if (comStatus != asynSuccess)
             {
                 motorParam->setInteger(pAxis->params, motorAxisCommError, 1);
@@ -807,8 +940,8 @@ static void EnsemblePoller(EnsembleController *pController)
                 }
             }
 
-            sprintf(outputBuff, "VFBK(@%d)", pAxis->axis);
-            comStatus = sendAndReceive(pController, outputBuff, inputBuff, sizeof(inputBuff));
+            comStatus = axisReplies[POLL_VFBK].status;
+            inputBuff = axisReplies[POLL_VFBK].reply;
             if (comStatus != asynSuccess)
             {
                 motorParam->setInteger(pAxis->params, motorAxisCommError, 1);
@@ -894,6 +1027,9 @@ int EnsembleAsynConfig(int card,             /* Controller number */
     pController->numAxes = numAxes;
     pController->movingPollPeriod = movingPollPeriod/1000.;
     pController->idlePollPeriod = idlePollPeriod/1000.;
+    pController->pipelinePoll = true;
+    pController->pipelineFailures = 0;
+    pController->pipelineHoldoff = 0;
 
     pController->sendReceiveMutex = epicsMutexMustCreate();
 
@@ -1062,3 +1198,50 @@ static asynStatus sendAndReceive(EnsembleController *pController, char *outputBu
     return(status);
 }
 
+
+/* Writes several EOS separated commands as one request and reads one reply per command.
+ * On an error the input is flushed, so that late replies are not taken as the reply to
+ * a later command. */
+static asynStatus sendAndReceiveMulti(EnsembleController *pController, char *outputBuff,
+                                      EnsemblePollReply *replies, int numCmds)
+{
+    size_t nWriteRequested;
+    size_t nWrite, nRead;
+    int eomReason;
+    int cmd;
+    asynStatus status;
+
+    if (pController == NULL)
+        return(asynError);
+
+    nWriteRequested = strlen(outputBuff);
+
+    epicsMutexLock(pController->sendReceiveMutex);
+
+    status = pasynOctetSyncIO->writeRead(pController->pasynUser, outputBuff, nWriteRequested,
+                               replies[0].reply, BUFFER_SIZE, TIMEOUT, &nWrite, &nRead, &eomReason);
+    if (nWrite != nWriteRequested)
+        status = asynError;
+    for (cmd = 0; cmd < numCmds && status == asynSuccess; cmd++)
+    {
+        if (cmd > 0)
+            status = pasynOctetSyncIO->read(pController->pasynUser, replies[cmd].reply, BUFFER_SIZE,
+                                            TIMEOUT, &nRead, &eomReason);
+        /* Skip an ACK without a value, as sendAndReceive does */
+        while (status == asynSuccess && nRead > 1 && replies[cmd].reply[0] == ASCII_ACK_CHAR &&
+               replies[cmd].reply[1] == ASCII_EOS_CHAR)
+            status = pasynOctetSyncIO->read(pController->pasynUser, replies[cmd].reply, BUFFER_SIZE,
+                                            TIMEOUT, &nRead, &eomReason);
+        replies[cmd].status = status;
+    }
+
+    if (status != asynSuccess)
+    {
+        asynPrint(pController->pasynUser, ASYN_TRACE_ERROR,
+                  "drvEnsembleAsyn:sendAndReceiveMulti error on reply %d of %d, status=%d, error=%s\n",
+                  cmd, numCmds, status, pController->pasynUser->errorMessage);
+        pasynOctetSyncIO->flush(pController->pasynUser);
+    }
+    epicsMutexUnlock(pController->sendReceiveMutex);
+    return(status);
+}
@@ -20,6 +20,10 @@ USAGE...	Simulated Motor Support.
  * 2010-10-05 rls - MP's fix for deferred moves broken in drvMotorSim.
  * 2012-10-09 rls - Added motorAxisforceCallback to support motor record
  *                GET_INFO commands.
+ * 2026-10-16     - Time steps come from motorSimClock, which can run faster
+ *                than real time or step deterministically.
+ *                motorAxisforceCallback updates the status without advancing
+ *                the motion.
  *
  */
 
@@ -45,6 +49,7 @@ USAGE...	Simulated Motor Support.
 #include "motor_interface.h"
 
 #include "route.h"
+#include "motorSimClock.h"
 
 motorAxisDrvSET_t motorSim = 
   {
@@ -81,7 +86,7 @@ typedef struct drvSim
   epicsThreadId motorThread;
   motorAxisLogFunc print;
   void * logParam;
-  epicsTimeStamp now;
+  motor_sim_clock_t clock;
   int movesDeferred;
   int nAxes;
 } motorSim_t;
@@ -118,7 +123,7 @@ static int motorSimLogMsg( void * param, const motorAxisLogMask_t logMask, const
 #define TRACE_FLOW    motorAxisTraceFlow
 #define TRACE_ERROR   motorAxisTraceError
 
-static motorSim_t drv={ NULL, NULL, motorSimLogMsg, NULL, { 0, 0 } };
+static motorSim_t drv={ NULL, NULL, motorSimLogMsg, NULL };
 
 #define MAX(a,b) ((a)>(b)? (a): (b))
 #define MIN(a,b) ((a)<(b)? (a): (b))
@@ -127,7 +132,7 @@ static motorSim_t drv={ NULL, NULL, motorSimLogMsg, NULL, { 0, 0 } };
 /*Deferred moves functions.*/
 static int processDeferredMoves(const motorSim_t * pDrv);
 
-static void motorProcTask(motorSim_t *);
+static void motorProcTask(motorSim_t *, double);
 
 static void motorAxisReportAxis( AXIS_HDL pAxis, int level )
 {
@@ -574,7 +579,7 @@ static int motorAxisforceCallback(AXIS_HDL pAxis)
 
   /* Force a status update. */
   motorParam->forceCallback(pAxis->params);
-  motorProcTask(&drv);
+  motorProcTask(&drv, 0.0);
   return(MOTOR_AXIS_OK);
 }
 
@@ -654,39 +659,31 @@ static void motorSimProcess( AXIS_HDL pAxis, double delta )
 }
 
 
-static void motorProcTask( motorSim_t *pDrv)
+static void motorProcTask( motorSim_t *pDrv, double delta )
 {
-  epicsTimeStamp now;
-  double delta;
   AXIS_HDL pAxis;
 
-  /* Get a new timestamp */
-  epicsTimeGetCurrent( &now );
-  delta = epicsTimeDiffInSeconds( &now, &(pDrv->now) );
-  pDrv->now = now;
-
-  if ( delta > (DELTA/4.0) && delta <= (4.0*DELTA) )
+  for (pAxis = pDrv->pFirst; pAxis != NULL; pAxis = pAxis->pNext )
   {
-    /* A reasonable time has elapsed, it's not a time step in the clock */
-
-    for (pAxis = pDrv->pFirst; pAxis != NULL; pAxis = pAxis->pNext )
+    if (epicsMutexLock( pAxis->axisMutex ) == epicsMutexLockOK)
     {
-      if (epicsMutexLock( pAxis->axisMutex ) == epicsMutexLockOK)
-      {
-        motorSimProcess( pAxis, delta );
-        motorParam->callCallback( pAxis->params );
-        epicsMutexUnlock( pAxis->axisMutex );
-      }
+      motorSimProcess( pAxis, delta );
+      motorParam->callCallback( pAxis->params );
+      epicsMutexUnlock( pAxis->axisMutex );
     }
   }
 }
 
 static void motorSimTask( motorSim_t * pDrv )
 {
+  double delta;
+
   while ( 1 )
     {
-      motorProcTask(pDrv);
-      epicsThreadSleep( DELTA );
+      /* Zero if no reasonable time has elapsed or it was a time step in the clock */
+      delta = motorSimClockDelta( &(pDrv->clock) );
+      if (delta > 0.0) motorProcTask(pDrv, delta);
+      motorSimClockWait( &(pDrv->clock) );
     }
 }
 
@@ -787,6 +784,7 @@ void motorSimCreate( int card, int axis, int lowLimit, int hiLimit, int home, in
 
   if (drv.motorThread==NULL)
     {
+      motorSimClockInit( &(drv.clock), DELTA );
       drv.motorThread = epicsThreadCreate( "motorSimThread", 
 					   epicsThreadPriorityLow,
 					   epicsThreadGetStackSize(epicsThreadStackMedium),
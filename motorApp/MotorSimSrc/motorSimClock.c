@@ -0,0 +1,217 @@
+/*
+FILENAME...  motorSimClock.c
+USAGE...     Time source for the motor simulators.
+
+By default the simulation threads follow the wall clock.  For benchmarks and
+reproducible tests the clock can be switched to fixed size ticks, either run
+faster than real time ("fast") or advanced one tick at a time ("step"):
+
+  motorSimClockMode("fast", 100)    ticks of DELTA simulated seconds every DELTA/100 s
+  motorSimClockMode("fast", 0)      ticks as fast as the threads can process them
+  motorSimClockMode("step", 0)      ticks only when granted by motorSimClockStep(n)
+  motorSimClockMode("realtime", 0)  back to the wall clock
+
+*/
+
+#include <string.h>
+#include <stdio.h>
+
+#include "epicsThread.h"
+#include "epicsMutex.h"
+#include "iocsh.h"
+#include "epicsExport.h"
+
+#include "motorSimClock.h"
+
+static motor_sim_clock_mode_t clockMode = MOTOR_SIM_CLOCK_REALTIME;
+static double clockRate = 1.0;
+static unsigned long stepsGranted = 0;
+static ELLLIST clockList;
+static epicsMutexId clockLock = NULL;
+
+static void clockListInit( void )
+{
+    /* Clocks are created from iocsh before any thread uses them */
+    if (clockLock == NULL)
+    {
+        ellInit( &clockList );
+        clockLock = epicsMutexMustCreate();
+    }
+}
+
+static void signalAllClocks( void )
+{
+    motor_sim_clock_t * pClock;
+
+    for (pClock = (motor_sim_clock_t *) ellFirst( &clockList ); pClock != NULL;
+         pClock = (motor_sim_clock_t *) ellNext( &pClock->node ))
+        epicsEventSignal( pClock->stepEvent );
+}
+
+void motorSimClockInit( motor_sim_clock_t * pClock, double period )
+{
+    clockListInit();
+
+    pClock->period = period;
+    pClock->simTime = 0.0;
+    epicsTimeGetCurrent( &pClock->start );
+    pClock->wallLast = pClock->start;
+    pClock->stepEvent = epicsEventMustCreate( epicsEventEmpty );
+
+    epicsMutexMustLock( clockLock );
+    pClock->stepsTaken = stepsGranted;
+    ellAdd( &clockList, &pClock->node );
+    epicsMutexUnlock( clockLock );
+}
+
+/** Return the simulated time to advance for this tick.
+
+  In real time mode this is the wall clock time since the last tick, or 0 if that
+  is not within DELTA/4..4*DELTA (a step in the clock).  Otherwise it is always
+  the nominal period, or 0 in step mode if no step has been granted.
+
+  \param pClock  [in]   Clock of the calling simulation thread.
+
+  \return Simulated seconds to propagate motion forwards, 0 to skip this tick.
+*/
+double motorSimClockDelta( motor_sim_clock_t * pClock )
+{
+    epicsTimeStamp now;
+    double delta = pClock->period;
+
+    epicsMutexMustLock( clockLock );
+    switch (clockMode)
+    {
+    case MOTOR_SIM_CLOCK_REALTIME:
+        epicsTimeGetCurrent( &now );
+        delta = epicsTimeDiffInSeconds( &now, &pClock->wallLast );
+        pClock->wallLast = now;
+        if (delta <= (pClock->period/4.0) || delta > (4.0*pClock->period)) delta = 0.0;
+        break;
+    case MOTOR_SIM_CLOCK_FAST:
+        break;
+    case MOTOR_SIM_CLOCK_STEP:
+        if (pClock->stepsTaken != stepsGranted) pClock->stepsTaken++;
+        else delta = 0.0;
+        break;
+    }
+    epicsMutexUnlock( clockLock );
+
+    pClock->simTime += delta;
+    return delta;
+}
+
+/** Wait until the next tick is due */
+void motorSimClockWait( motor_sim_clock_t * pClock )
+{
+    motor_sim_clock_mode_t mode;
+    double rate;
+    int pending;
+
+    epicsMutexMustLock( clockLock );
+    mode = clockMode;
+    rate = clockRate;
+    pending = (pClock->stepsTaken != stepsGranted);
+    epicsMutexUnlock( clockLock );
+
+    switch (mode)
+    {
+    case MOTOR_SIM_CLOCK_REALTIME:
+        epicsThreadSleep( pClock->period );
+        break;
+    case MOTOR_SIM_CLOCK_FAST:
+        epicsThreadSleep( (rate > 0.0) ? pClock->period/rate : 0.0 );
+        break;
+    case MOTOR_SIM_CLOCK_STEP:
+        /* motorSimClockStep and motorSimClockMode signal the event */
+        if (!pending) epicsEventWait( pClock->stepEvent );
+        break;
+    }
+}
+
+/** Return the simulated time, which starts at the wall clock time the clock was created */
+void motorSimClockGetTime( motor_sim_clock_t * pClock, epicsTimeStamp * time )
+{
+    *time = pClock->start;
+    epicsTimeAddSeconds( time, pClock->simTime );
+}
+
+int motorSimClockMode( const char * mode, double rate )
+{
+    motor_sim_clock_mode_t newMode;
+    motor_sim_clock_t * pClock;
+
+    if (mode == NULL || strcmp( mode, "realtime" ) == 0) newMode = MOTOR_SIM_CLOCK_REALTIME;
+    else if (strcmp( mode, "fast" ) == 0) newMode = MOTOR_SIM_CLOCK_FAST;
+    else if (strcmp( mode, "step" ) == 0) newMode = MOTOR_SIM_CLOCK_STEP;
+    else
+    {
+        printf( "motorSimClockMode: unknown mode %s, use realtime, fast or step\n", mode );
+        return -1;
+    }
+
+    clockListInit();
+    epicsMutexMustLock( clockLock );
+    clockMode = newMode;
+    clockRate = rate;
+    for (pClock = (motor_sim_clock_t *) ellFirst( &clockList ); pClock != NULL;
+         pClock = (motor_sim_clock_t *) ellNext( &pClock->node ))
+    {
+        /* Don't count the wait as elapsed time, and drop steps not yet taken */
+        epicsTimeGetCurrent( &pClock->wallLast );
+        pClock->stepsTaken = stepsGranted;
+    }
+    signalAllClocks();
+    epicsMutexUnlock( clockLock );
+    return 0;
+}
+
+int motorSimClockStep( int steps )
+{
+    if (steps <= 0) return 0;
+
+    clockListInit();
+    epicsMutexMustLock( clockLock );
+    if (clockMode != MOTOR_SIM_CLOCK_STEP)
+    {
+        epicsMutexUnlock( clockLock );
+        printf( "motorSimClockStep: clock is not in step mode\n" );
+        return -1;
+    }
+    stepsGranted += steps;
+    signalAllClocks();
+    epicsMutexUnlock( clockLock );
+    return 0;
+}
+
+/** Code for iocsh registration */
+static const iocshArg motorSimClockModeArg0 = { "Mode (realtime, fast, step)", iocshArgString};
+static const iocshArg motorSimClockModeArg1 = { "Rate",                        iocshArgDouble};
+static const iocshArg *const motorSimClockModeArgs[] = {
+  &motorSimClockModeArg0,
+  &motorSimClockModeArg1
+};
+static const iocshFuncDef motorSimClockModeDef = {"motorSimClockMode", 2, motorSimClockModeArgs};
+
+static void motorSimClockModeCallFunc(const iocshArgBuf *args)
+{
+  motorSimClockMode(args[0].sval, args[1].dval);
+}
+
+static const iocshArg motorSimClockStepArg0 = { "Number of ticks", iocshArgInt};
+static const iocshArg *const motorSimClockStepArgs[] = {
+  &motorSimClockStepArg0
+};
+static const iocshFuncDef motorSimClockStepDef = {"motorSimClockStep", 1, motorSimClockStepArgs};
+
+static void motorSimClockStepCallFunc(const iocshArgBuf *args)
+{
+  motorSimClockStep(args[0].ival);
+}
+
+static void motorSimClockRegister(void)
+{
+  iocshRegister(&motorSimClockModeDef, motorSimClockModeCallFunc);
+  iocshRegister(&motorSimClockStepDef, motorSimClockStepCallFunc);
+}
+epicsExportRegistrar(motorSimClockRegister);
@@ -0,0 +1,43 @@
+#ifndef __INCmotorSimClockh
+#define __INCmotorSimClockh
+
+#include "epicsTime.h"
+#include "epicsEvent.h"
+#include "ellLib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    MOTOR_SIM_CLOCK_REALTIME = 0,     /* Follow the wall clock                          */
+    MOTOR_SIM_CLOCK_FAST     = 1,     /* Fixed steps, run "rate" times faster than real */
+    MOTOR_SIM_CLOCK_STEP     = 2      /* Fixed steps, only when granted by motorSimClockStep */
+} motor_sim_clock_mode_t;
+
+/* Time source of one simulation thread */
+typedef struct motor_sim_clock_str
+{
+    ELLNODE node;
+    double period;                    /* Nominal tick period in simulated seconds       */
+    double simTime;                   /* Simulated seconds since the clock was created  */
+    epicsTimeStamp start;             /* Wall clock time when the clock was created     */
+    epicsTimeStamp wallLast;          /* Wall clock time of the last real time tick     */
+    unsigned long stepsTaken;         /* Ticks taken in step mode                       */
+    epicsEventId stepEvent;           /* Signalled when steps are granted               */
+} motor_sim_clock_t;
+
+void motorSimClockInit( motor_sim_clock_t * pClock, double period );
+double motorSimClockDelta( motor_sim_clock_t * pClock );
+void motorSimClockWait( motor_sim_clock_t * pClock );
+void motorSimClockGetTime( motor_sim_clock_t * pClock, epicsTimeStamp * time );
+
+int motorSimClockMode( const char * mode, double rate );
+int motorSimClockStep( int steps );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCmotorSimClockh */
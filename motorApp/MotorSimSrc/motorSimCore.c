@@ -0,0 +1,112 @@
+/*
+FILENAME...  motorSimCore.c
+USAGE...     Trapezoidal kinematics for all axes of a simulated controller.
+
+The axes are advanced together, one array element per axis, so that the
+per-tick cost stays small for controllers with hundreds of axes.  Each axis
+either follows a demand velocity (jog, home, stop) or moves to a demand
+position with a trapezoidal velocity profile limited by vmax and amax.
+
+*/
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "motorSimCore.h"
+
+/* Number of arrays of doubles in motor_sim_core_t */
+#define NUM_DOUBLE_ARRAYS 7
+
+motor_sim_core_t * motorSimCoreNew( int numAxes, double start )
+{
+    motor_sim_core_t * core;
+    double * block;
+    int i;
+
+    core = (motor_sim_core_t *) calloc( 1, sizeof(motor_sim_core_t) );
+    block = (double *) calloc( NUM_DOUBLE_ARRAYS * numAxes, sizeof(double) );
+    core->velocityMode = (int *) calloc( numAxes, sizeof(int) );
+    if (block == NULL || core->velocityMode == NULL)
+    {
+        free( block );
+        free( core->velocityMode );
+        free( core );
+        return NULL;
+    }
+
+    core->numAxes        = numAxes;
+    core->position       = block;
+    core->velocity       = block + numAxes;
+    core->lastPosition   = block + 2 * numAxes;
+    core->target         = block + 3 * numAxes;
+    core->targetVelocity = block + 4 * numAxes;
+    core->vmax           = block + 5 * numAxes;
+    core->amax           = block + 6 * numAxes;
+
+    for (i = 0; i < numAxes; i++)
+    {
+        core->position[i] = start;
+        core->lastPosition[i] = start;
+        core->target[i] = start;
+        core->vmax[i] = 1.0;
+        core->amax[i] = 1.0;
+    }
+    return core;
+}
+
+void motorSimCoreDelete( motor_sim_core_t * core )
+{
+    if (core == NULL) return;
+    free( core->position );
+    free( core->velocityMode );
+    free( core );
+}
+
+/** Advance all axes by one time step.
+
+  In position mode the demand velocity is the largest velocity from which the
+  axis can still stop at the target one step late, limited to vmax.  In velocity mode it is
+  targetVelocity.  The velocity then approaches the demand velocity at amax.
+  An axis that arrives at its target slowly enough is placed exactly on it
+  and stopped.
+
+  \param core   [in]   Kinematic state of the controller's axes.
+  \param delta  [in]   Time in seconds to propagate motion forwards.
+*/
+void motorSimCoreAdvance( motor_sim_core_t * core, double delta )
+{
+    double * pos = core->position;
+    double * vel = core->velocity;
+    int n = core->numAxes;
+    int i;
+
+    if (delta <= 0.0) return;
+
+    for (i = 0; i < n; i++)
+    {
+        double p    = pos[i];
+        double v    = vel[i];
+        double a    = core->amax[i];
+        double dv   = a * delta;
+        double dist = core->target[i] - p;
+        double stop = sqrt( dv * dv + 2.0 * a * fabs(dist) ) - dv;
+        double vdes = (stop < core->vmax[i]) ? stop : core->vmax[i];
+        double vnew;
+        int arrived;
+
+        vdes = (dist < 0.0) ? -vdes : vdes;
+        vdes = core->velocityMode[i] ? core->targetVelocity[i] : vdes;
+
+        vnew = (vdes > v + dv) ? v + dv : ((vdes < v - dv) ? v - dv : vdes);
+        p += 0.5 * (v + vnew) * delta;
+
+        /* Snap to the target once it is reached or passed at low speed */
+        arrived = !core->velocityMode[i] &&
+                  dist * (core->target[i] - p) <= 0.0 &&
+                  fabs(vnew) <= 2.0 * dv;
+
+        core->lastPosition[i] = pos[i];
+        pos[i] = arrived ? core->target[i] : p;
+        vel[i] = arrived ? 0.0 : vnew;
+    }
+}
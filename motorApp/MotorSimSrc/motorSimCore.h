@@ -0,0 +1,31 @@
+#ifndef __INCmotorSimCoreh
+#define __INCmotorSimCoreh
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Kinematic state of all axes of one simulated controller, stored as one
+   array per quantity so that a tick is a single pass over contiguous memory */
+typedef struct motor_sim_core_str
+{
+    int numAxes;
+    double * position;        /* Current position                              */
+    double * velocity;        /* Current velocity                              */
+    double * lastPosition;    /* Position before the last tick                 */
+    double * target;          /* Demand position in position mode              */
+    double * targetVelocity;  /* Demand velocity in velocity mode              */
+    double * vmax;            /* Maximum velocity in position mode             */
+    double * amax;            /* Maximum acceleration                          */
+    int    * velocityMode;    /* Non-zero: follow targetVelocity, not target   */
+} motor_sim_core_t;
+
+motor_sim_core_t * motorSimCoreNew( int numAxes, double start );
+void motorSimCoreDelete( motor_sim_core_t * core );
+void motorSimCoreAdvance( motor_sim_core_t * core, double delta );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCmotorSimCoreh */
@@ -32,6 +32,8 @@ December 13, 2009
 #define DEFAULT_HI_LIMIT   10000
 #define DEFAULT_HOME       0
 #define DEFAULT_START      0
+#define DELTA 0.1
+#define TWO_PI 6.28318530717958647692
 
 static const char *driverName = "motorSimDriver";
 
@@ -51,22 +53,15 @@ motorSimAxis::motorSimAxis(motorSimController *pController, int axis, double low
     pC_(pController),
     lowHardLimit_(lowHardLimit), hiHardLimit_(hiHardLimit), home_(home)
 {
-  route_pars_t pars;
-
-  pars.numRoutedAxes = 1;
-  pars.routedAxisList[0] = 1;
-  pars.Tsync = 0.0;
-  pars.Tcoast = 0.0;
-  pars.axis[0].Amax = 1.0;
-  pars.axis[0].Vmax = 1.0;
-
-  endpoint_.T = 0;
-  endpoint_.axis[0].p = start;
-  endpoint_.axis[0].v = 0;
-  nextpoint_.T = 0;
-  nextpoint_.axis[0].p = start;
-  route_ = routeNew( &(this->endpoint_), &pars );
+  pC_->core_->position[axisNo_] = start;
+  pC_->core_->lastPosition[axisNo_] = start;
+  pC_->core_->target[axisNo_] = start;
   deferred_move_ = 0;
+  profileInUse_ = 0;
+  profileOffset_ = 0.0;
+  profileVelocities_ = NULL;
+  gatherReadbacks_ = NULL;
+  gatherErrors_ = NULL;
 }
 
 
@@ -95,11 +90,22 @@ motorSimController::motorSimController(const char *portName, int numAxes, int pr
   if (numAxes < 1 ) numAxes = 1;
   numAxes_ = numAxes;
   this->movesDeferred_ = 0;
+  simProfileTimes_ = NULL;
+  simProfileNumPoints_ = 0;
+  simProfileState_ = SIM_PROFILE_IDLE;
+  simProfileStart_ = 0.0;
+  simServoLag_ = 0.0;
+  simNoise_ = 0.0;
+  simSampleRate_ = 0.0;
+  simNumSamples_ = 0;
+  simNoiseSeed_ = 1;
+  this->core_ = motorSimCoreNew(numAxes, DEFAULT_START);
   for (axis=0; axis<numAxes; axis++) {
     new motorSimAxis(this, axis, DEFAULT_LOW_LIMIT, DEFAULT_HI_LIMIT, DEFAULT_HOME, DEFAULT_START);
     setDoubleParam(axis, this->motorPosition_, DEFAULT_START);
   }
 
+  motorSimClockInit(&clock_, DELTA);
   this->motorThread_ = epicsThreadCreate("motorSimThread", 
                                          epicsThreadPriorityLow,
                                          epicsThreadGetStackSize(epicsThreadStackMedium),
@@ -123,14 +129,16 @@ void motorSimController::report(FILE *fp, int level)
       double lowSoftLimit=0.0;
       double hiSoftLimit=0.0;
 
-      fprintf(fp, "  Current position = %f, velocity = %f at current time: %f\n", 
-           pAxis->nextpoint_.axis[0].p, 
-           pAxis->nextpoint_.axis[0].v,
-           pAxis->nextpoint_.T);
-      fprintf(fp, "  Destination posn = %f, velocity = %f at desination time:  %f\n",
-           pAxis->endpoint_.axis[0].p, 
-           pAxis->endpoint_.axis[0].v,
-           pAxis->endpoint_.T);
+      fprintf(fp, "  Current position = %f, velocity = %f\n", 
+           core_->position[axis], 
+           core_->velocity[axis]);
+      if (core_->velocityMode[axis])
+        fprintf(fp, "  Demand velocity = %f\n", core_->targetVelocity[axis]);
+      else
+        fprintf(fp, "  Destination posn = %f, max. velocity = %f\n",
+             core_->target[axis], 
+             core_->vmax[axis]);
+      fprintf(fp, "    Acceleration: %f\n", core_->amax[axis]);
 
       fprintf(fp, "    Hard limits: %f, %f\n", pAxis->lowHardLimit_, pAxis->hiHardLimit_);
       fprintf(fp, "           Home: %f\n", pAxis->home_);
@@ -142,6 +150,9 @@ void motorSimController::report(FILE *fp, int level)
       if (pAxis->homing_) fprintf(fp, "    Currently homing axis\n" );
     }
   }
+  if (maxProfilePoints_ > 0)
+    fprintf(fp, "  Profile: maxPoints=%d, servo lag=%f, noise=%f, sample rate=%f\n",
+            (int)maxProfilePoints_, simServoLag_, simNoise_, simSampleRate_);
 
   // Call the base class method
   asynMotorController::report(fp, level);
@@ -160,10 +171,10 @@ asynStatus motorSimController::processDeferredMoves()
     if (pAxis->deferred_move_) {
       position = pAxis->deferred_position_;
       /* Check to see if in hard limits */
-      if ((pAxis->nextpoint_.axis[0].p >= pAxis->hiHardLimit_  &&  position > pAxis->nextpoint_.axis[0].p) ||
-          (pAxis->nextpoint_.axis[0].p <= pAxis->lowHardLimit_ &&  position < pAxis->nextpoint_.axis[0].p)) return asynError;
-      pAxis->endpoint_.axis[0].p = position - pAxis->enc_offset_;
-      pAxis->endpoint_.axis[0].v = 0.0;    
+      if ((core_->position[axis] >= pAxis->hiHardLimit_  &&  position > core_->position[axis]) ||
+          (core_->position[axis] <= pAxis->lowHardLimit_ &&  position < core_->position[axis])) return asynError;
+      core_->target[axis] = position - pAxis->enc_offset_;
+      core_->velocityMode[axis] = 0;
       setIntegerParam(axis, motorStatusDone_, 0);
       pAxis->deferred_move_ = 0;
     }
@@ -232,66 +243,404 @@ asynStatus motorSimController::triggerProfile(asynUser *pasynUser)
   return asynError;
 }
 
+/** Allocates the profile arrays of the controller and its axes.
+  * \param[in] maxPoints Maximum number of profile points, also the maximum number of gathered samples. */
+asynStatus motorSimController::initializeProfile(size_t maxPoints)
+{
+  asynMotorController::initializeProfile(maxPoints);
+  if (simProfileTimes_) free(simProfileTimes_);
+  simProfileTimes_ = (double *)calloc(maxPoints, sizeof(double));
+  simProfileNumPoints_ = 0;
+  return asynSuccess;
+}
+
+asynStatus motorSimAxis::initializeProfile(size_t maxPoints)
+{
+  asynMotorAxis::initializeProfile(maxPoints);
+  if (profileVelocities_) free(profileVelocities_);
+  profileVelocities_ = (double *)calloc(maxPoints, sizeof(double));
+  if (gatherReadbacks_)   free(gatherReadbacks_);
+  gatherReadbacks_ =   (double *)calloc(maxPoints, sizeof(double));
+  if (gatherErrors_)      free(gatherErrors_);
+  gatherErrors_ =      (double *)calloc(maxPoints, sizeof(double));
+  return asynSuccess;
+}
+
+/** Allocates the profile arrays and sets the servo model used when executing profiles.
+  * \param[in] maxPoints Maximum number of profile points and gathered samples.
+  * \param[in] servoLag Time in seconds by which the axes follow the profile setpoint.
+  * \param[in] noise Standard deviation of the gathered readbacks in controller units.
+  * \param[in] sampleRate Gathering rate in Hz, 0 to gather once at each profile point. */
+asynStatus motorSimController::configProfile(size_t maxPoints, double servoLag, double noise, double sampleRate)
+{
+  lock();
+  initializeProfile(maxPoints);
+  simServoLag_   = (servoLag > 0.0)   ? servoLag   : 0.0;
+  simNoise_      = (noise > 0.0)      ? noise      : 0.0;
+  simSampleRate_ = (sampleRate > 0.0) ? sampleRate : 0.0;
+  unlock();
+  return asynSuccess;
+}
+
+/** Builds a PVT profile from the profile positions and times.
+  * The velocity at the first and last points is zero, the velocity at the other points is
+  * the average velocity of the two segments either side of the point. */
+asynStatus motorSimController::buildProfile()
+{
+  motorSimAxis *pAxis;
+  char message[MAX_MESSAGE_LEN];
+  bool buildOK = true;
+  int numPoints;
+  int numUsed = 0;
+  int useAxis;
+  int axis;
+  int i;
+  double *p;
+  double *v;
+  static const char *functionName = "buildProfile";
+
+  // Call the base class method which will build the time array if needed
+  asynMotorController::buildProfile();
+
+  strcpy(message, "");
+  setStringParam(profileBuildMessage_, message);
+  setIntegerParam(profileBuildState_, PROFILE_BUILD_BUSY);
+  setIntegerParam(profileBuildStatus_, PROFILE_STATUS_UNDEFINED);
+  callParamCallbacks();
+
+  simProfileNumPoints_ = 0;
+  getIntegerParam(profileNumPoints_, &numPoints);
+  if ((numPoints < 2) || (numPoints > (int)maxProfilePoints_)) {
+    buildOK = false;
+    sprintf(message, "Invalid number of points=%d, must be 2 to %d", numPoints, (int)maxProfilePoints_);
+    goto done;
+  }
+  simProfileTimes_[0] = 0.0;
+  for (i=0; i<numPoints-1; i++) {
+    if (profileTimes_[i] <= 0.0) {
+      buildOK = false;
+      sprintf(message, "Invalid time=%f for point %d", profileTimes_[i], i);
+      goto done;
+    }
+    simProfileTimes_[i+1] = simProfileTimes_[i] + profileTimes_[i];
+  }
+  if ((simSampleRate_ > 0.0) && 
+      (simProfileTimes_[numPoints-1] * simSampleRate_ >= maxProfilePoints_)) {
+    buildOK = false;
+    sprintf(message, "Profile time=%f needs more than %d samples", 
+            simProfileTimes_[numPoints-1], (int)maxProfilePoints_);
+    goto done;
+  }
+
+  for (axis=0; axis<numAxes_; axis++) {
+    pAxis = getAxis(axis);
+    getIntegerParam(axis, profileUseAxis_, &useAxis);
+    pAxis->profileInUse_ = useAxis;
+    if (!useAxis) continue;
+    numUsed++;
+    p = pAxis->profilePositions_;
+    v = pAxis->profileVelocities_;
+    v[0] = 0.0;
+    v[numPoints-1] = 0.0;
+    for (i=1; i<numPoints-1; i++) {
+      v[i] = (p[i+1] - p[i-1]) / (simProfileTimes_[i+1] - simProfileTimes_[i-1]);
+    }
+  }
+  if (numUsed == 0) {
+    buildOK = false;
+    sprintf(message, "No axes selected for the profile");
+    goto done;
+  }
+  simProfileNumPoints_ = numPoints;
+
+  done:
+  setIntegerParam(profileBuildStatus_, buildOK ? PROFILE_STATUS_SUCCESS : PROFILE_STATUS_FAILURE);
+  setStringParam(profileBuildMessage_, message);
+  if (!buildOK) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s: %s\n",
+              driverName, functionName, message);
+  }
+  /* Clear build command.  This is a "busy" record, don't want to do this until build is complete. */
+  setIntegerParam(profileBuild_, 0);
+  setIntegerParam(profileBuildState_, PROFILE_BUILD_DONE);
+  callParamCallbacks();
+  return buildOK ? asynSuccess : asynError;
+}
+
+/** Starts the profile built by buildProfile().
+  * The axes first move to the first profile point, then motorSimTask runs the profile
+  * and gathers the readbacks, so this returns without waiting for the profile to complete. */
+asynStatus motorSimController::executeProfile()
+{
+  motorSimAxis *pAxis;
+  motor_sim_core_t *core = core_;
+  int moveMode;
+  int axis;
+  static const char *functionName = "executeProfile";
+
+  setStringParam(profileExecuteMessage_, "");
+  setIntegerParam(profileExecuteStatus_, PROFILE_STATUS_UNDEFINED);
+  setIntegerParam(profileCurrentPoint_, 0);
+  if ((simProfileNumPoints_ == 0) || (simProfileState_ != SIM_PROFILE_IDLE)) {
+    setStringParam(profileExecuteMessage_, 
+                   simProfileNumPoints_ ? "Profile already executing" : "Profile not built");
+    setIntegerParam(profileExecuteStatus_, PROFILE_STATUS_FAILURE);
+    setIntegerParam(profileExecute_, 0);
+    callParamCallbacks();
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s: profile not built or already executing\n",
+              driverName, functionName);
+    return asynError;
+  }
+
+  getIntegerParam(profileMoveMode_, &moveMode);
+  for (axis=0; axis<numAxes_; axis++) {
+    pAxis = getAxis(axis);
+    if (!pAxis->profileInUse_) continue;
+    pAxis->profileOffset_ = (moveMode == PROFILE_MOVE_MODE_RELATIVE) ? 
+                            core->position[axis] + pAxis->enc_offset_ : 0.0;
+    core->target[axis] = pAxis->profilePositions_[0] + pAxis->profileOffset_ - pAxis->enc_offset_;
+    core->velocityMode[axis] = 0;
+    pAxis->setIntegerParam(motorStatusDone_, 0);
+    pAxis->callParamCallbacks();
+  }
+  simNumSamples_ = 0;
+  simNoiseSeed_ = 1;
+  simProfileState_ = SIM_PROFILE_MOVE_START;
+  setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_MOVE_START);
+  callParamCallbacks();
+  return asynSuccess;
+}
+
+/** Stops the axes of an executing profile. */
+asynStatus motorSimController::abortProfile()
+{
+  motorSimAxis *pAxis;
+  int axis;
+
+  if (simProfileState_ == SIM_PROFILE_IDLE) return asynSuccess;
+  for (axis=0; axis<numAxes_; axis++) {
+    pAxis = getAxis(axis);
+    if (pAxis->profileInUse_) pAxis->setVelocity(0.0, 0.0);
+  }
+  simProfileState_ = SIM_PROFILE_IDLE;
+  setIntegerParam(profileActualPulses_, simNumSamples_);
+  setStringParam(profileExecuteMessage_, "Profile aborted");
+  setIntegerParam(profileExecuteStatus_, PROFILE_STATUS_ABORT);
+  setIntegerParam(profileExecute_, 0);
+  setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_DONE);
+  callParamCallbacks();
+  return asynSuccess;
+}
+
+/** Posts the readbacks and following errors gathered by the last profile execution. */
+asynStatus motorSimController::readbackProfile()
+{
+  motorSimAxis *pAxis;
+  int axis;
+
+  setStringParam(profileReadbackMessage_, "");
+  setIntegerParam(profileReadbackState_, PROFILE_READBACK_BUSY);
+  setIntegerParam(profileReadbackStatus_, PROFILE_STATUS_UNDEFINED);
+  callParamCallbacks();
+
+  setIntegerParam(profileNumReadbacks_, simNumSamples_);
+  /* The axis method converts the arrays in place, so give it a copy of the gathered data */
+  for (axis=0; axis<numAxes_; axis++) {
+    pAxis = getAxis(axis);
+    memcpy(pAxis->profileReadbacks_,       pAxis->gatherReadbacks_, simNumSamples_*sizeof(double));
+    memcpy(pAxis->profileFollowingErrors_, pAxis->gatherErrors_,    simNumSamples_*sizeof(double));
+    pAxis->readbackProfile();
+  }
+
+  setIntegerParam(profileReadbackStatus_, PROFILE_STATUS_SUCCESS);
+  /* Clear readback command.  This is a "busy" record, don't want to do this until readback is complete. */
+  setIntegerParam(profileReadback_, 0);
+  setIntegerParam(profileReadbackState_, PROFILE_READBACK_DONE);
+  callParamCallbacks();
+  return asynSuccess;
+}
+
+/** Returns the profile setpoint of an axis in controller units.
+  * Positions between points are interpolated with cubic Hermite polynomials through the
+  * positions and velocities of the points.  Before the start and after the end of the
+  * profile the setpoint is the first and last point.
+  * \param[in] pAxis The axis.
+  * \param[in] time Time from the start of the profile.
+  * \param[in,out] segment Segment containing the previous time.  Successive calls with the
+  *                same cursor must not go back in time. */
+double motorSimController::profileSetpoint(motorSimAxis *pAxis, double time, int *segment)
+{
+  double *p = pAxis->profilePositions_;
+  double *v = pAxis->profileVelocities_;
+  double *t = simProfileTimes_;
+  int last = simProfileNumPoints_ - 1;
+  int i;
+  double h, s, s2, s3;
+
+  if (time <= 0.0) return p[0] + pAxis->profileOffset_;
+  if (time >= t[last]) return p[last] + pAxis->profileOffset_;
+  while ((*segment < last-1) && (time >= t[*segment+1])) (*segment)++;
+  i = *segment;
+  h = t[i+1] - t[i];
+  s = (time - t[i]) / h;
+  s2 = s*s;
+  s3 = s2*s;
+  return (2*s3 - 3*s2 + 1) * p[i] + (s3 - 2*s2 + s) * h * v[i] +
+         (-2*s3 + 3*s2) * p[i+1] + (s3 - s2) * h * v[i+1] + pAxis->profileOffset_;
+}
+
+/** Returns the time of a gathered sample from the start of the profile */
+double motorSimController::profileSampleTime(int sample)
+{
+  if (simSampleRate_ > 0.0) return sample / simSampleRate_;
+  return simProfileTimes_[sample];
+}
+
+/** Returns gaussian noise with standard deviation simNoise_.
+  * The generator is reseeded for each execution so that repeated runs gather the same data. */
+double motorSimController::profileNoise()
+{
+  double u1, u2;
+
+  if (simNoise_ == 0.0) return 0.0;
+  simNoiseSeed_ = simNoiseSeed_ * 1103515245u + 12345u;
+  u1 = ((simNoiseSeed_ >> 8) + 1.0) / 16777217.0;
+  simNoiseSeed_ = simNoiseSeed_ * 1103515245u + 12345u;
+  u2 = (simNoiseSeed_ >> 8) / 16777216.0;
+  return simNoise_ * sqrt(-2.0 * log(u1)) * cos(TWO_PI * u2);
+}
+
+/** Advances the profile move to the current simulated time.
+  * Called from motorSimTask with the lock held, after the core has advanced the axes.
+  * The axes follow the setpoint delayed by the servo lag, and the samples due since the
+  * last call are gathered.
+  * \param[in] delta Time in seconds since the last call. */
+void motorSimController::profileStep(double delta)
+{
+  motor_sim_core_t *core = core_;
+  motorSimAxis *pAxis;
+  int last = simProfileNumPoints_ - 1;
+  int numSamples = (simSampleRate_ > 0.0) ? 
+                   (int)(simProfileTimes_[last] * simSampleRate_) + 1 : simProfileNumPoints_;
+  double time;
+  double sampleTime;
+  double setpoint;
+  double actual;
+  int axis;
+
+  if (simProfileState_ == SIM_PROFILE_MOVE_START) {
+    for (axis=0; axis<numAxes_; axis++) {
+      if (!getAxis(axis)->profileInUse_) continue;
+      if ((core->velocity[axis] != 0.0) || (core->position[axis] != core->target[axis])) return;
+    }
+    simMotionSegment_ = 0;
+    simSampleSegment_ = 0;
+    simLagSegment_ = 0;
+    simProfileStart_ = clock_.simTime;
+    simProfileState_ = SIM_PROFILE_EXECUTING;
+    setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_EXECUTING);
+    callParamCallbacks();
+    return;
+  }
+
+  time = clock_.simTime - simProfileStart_;
+  while ((simNumSamples_ < numSamples) && (profileSampleTime(simNumSamples_) <= time)) {
+    sampleTime = profileSampleTime(simNumSamples_);
+    for (axis=0; axis<numAxes_; axis++) {
+      pAxis = getAxis(axis);
+      if (pAxis->profileInUse_) {
+        setpoint = profileSetpoint(pAxis, sampleTime, &simSampleSegment_);
+        actual = profileSetpoint(pAxis, sampleTime - simServoLag_, &simLagSegment_) + profileNoise();
+      } else {
+        setpoint = actual = core->position[axis] + pAxis->enc_offset_;
+      }
+      pAxis->gatherReadbacks_[simNumSamples_] = actual;
+      pAxis->gatherErrors_[simNumSamples_] = actual - setpoint;
+    }
+    simNumSamples_++;
+  }
+
+  for (axis=0; axis<numAxes_; axis++) {
+    pAxis = getAxis(axis);
+    if (!pAxis->profileInUse_) continue;
+    core->lastPosition[axis] = core->position[axis];
+    core->position[axis] = profileSetpoint(pAxis, time - simServoLag_, &simMotionSegment_) - pAxis->enc_offset_;
+    core->target[axis] = core->position[axis];
+    core->velocity[axis] = (core->position[axis] - core->lastPosition[axis]) / delta;
+  }
+  setIntegerParam(profileCurrentPoint_, simMotionSegment_);
+
+  if (time < simProfileTimes_[last] + simServoLag_) return;
+  for (axis=0; axis<numAxes_; axis++) {
+    if (getAxis(axis)->profileInUse_) core->velocity[axis] = 0.0;
+  }
+  simProfileState_ = SIM_PROFILE_IDLE;
+  setIntegerParam(profileCurrentPoint_, last);
+  setIntegerParam(profileActualPulses_, simNumSamples_);
+  setIntegerParam(profileExecuteStatus_, PROFILE_STATUS_SUCCESS);
+  /* Clear execute command.  This is a "busy" record, don't want to do this until execute is complete. */
+  setIntegerParam(profileExecute_, 0);
+  setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_DONE);
+  callParamCallbacks();
+}
+
 static void motorSimTaskC(void *drvPvt)
 {
   motorSimController *pController = (motorSimController*)drvPvt;
   pController->motorSimTask();
 }
   
-
-#define DELTA 0.1
 void motorSimController::motorSimTask()
 {
-  epicsTimeStamp now;
   double delta;
   int axis;
   motorSimAxis *pAxis;
 
   while ( 1 )
   {
-    /* Get a new timestamp */
-    epicsTimeGetCurrent( &now );
-    delta = epicsTimeDiffInSeconds( &now, &(prevTime_) );
-    prevTime_ = now;
+    /* Get the time step, zero if it's not a reasonable time or a step in the clock */
+    delta = motorSimClockDelta( &clock_ );
 
-    if ( delta > (DELTA/4.0) && delta <= (4.0*DELTA) )
+    if ( delta > 0.0 )
     {
-      /* A reasonable time has elapsed, it's not a time step in the clock */
+      /* Advance all axes in one pass, then update limits and status per axis */
+      this->lock();
+      motorSimCoreAdvance(core_, delta);
+      if (simProfileState_ != SIM_PROFILE_IDLE) profileStep(delta);
       for (axis=0; axis<numAxes_; axis++) 
       {     
-        this->lock();
         pAxis = getAxis(axis);
         pAxis->process(delta );
-        this->unlock();
       }
+      this->unlock();
     }
-    epicsThreadSleep( DELTA );
+    motorSimClockWait( &clock_ );
   }
 }
 
 asynStatus motorSimAxis::move(double position, int relative, double minVelocity, double maxVelocity, double acceleration)
 {
-  route_pars_t pars;
+  motor_sim_core_t *core = pC_->core_;
   static const char *functionName = "move";
 
-  if (relative) position += endpoint_.axis[0].p + enc_offset_;
+  if (relative) position += core->target[axisNo_] + enc_offset_;
 
   /* Check to see if in hard limits */
-  if ((nextpoint_.axis[0].p >= hiHardLimit_  &&  position > nextpoint_.axis[0].p) ||
-    (nextpoint_.axis[0].p <= lowHardLimit_ &&  position < nextpoint_.axis[0].p)  ) return asynError;
+  if ((core->position[axisNo_] >= hiHardLimit_  &&  position > core->position[axisNo_]) ||
+    (core->position[axisNo_] <= lowHardLimit_ &&  position < core->position[axisNo_])  ) return asynError;
 
   if (pC_->movesDeferred_ == 0) { /*Normal move.*/
-    endpoint_.axis[0].p = position - enc_offset_;
-    endpoint_.axis[0].v = 0.0;
+    core->target[axisNo_] = position - enc_offset_;
+    core->velocityMode[axisNo_] = 0;
   } else { /*Deferred moves.*/
     deferred_position_ = position;
     deferred_move_ = 1;
     deferred_relative_ = relative;
   }
-  routeGetParams(route_, &pars);
-  if (maxVelocity != 0) pars.axis[0].Vmax = fabs(maxVelocity);
-  if (acceleration != 0) pars.axis[0].Amax = fabs(acceleration);
-  routeSetParams( route_, &pars ); 
+  if (maxVelocity != 0) core->vmax[axisNo_] = fabs(maxVelocity);
+  if (acceleration != 0) core->amax[axisNo_] = fabs(acceleration);
 
   setIntegerParam(pC_->motorStatusDone_, 0);
   callParamCallbacks();
@@ -304,24 +653,16 @@ asynStatus motorSimAxis::move(double position, int relative, double minVelocity,
 
 asynStatus motorSimAxis::setVelocity(double velocity, double acceleration )
 {
-  route_pars_t pars;
-  double deltaV = velocity - this->nextpoint_.axis[0].v;        
-  double time;
+  motor_sim_core_t *core = pC_->core_;
 
   /* Check to see if in hard limits */
-  if ((this->nextpoint_.axis[0].p > hiHardLimit_ && velocity > 0) ||
-      (this->nextpoint_.axis[0].p < lowHardLimit_ && velocity < 0)  ) return asynError;
-
-  routeGetParams( this->route_, &pars );
-  if (acceleration != 0) pars.axis[0].Amax = fabs(acceleration);
-  routeSetParams( this->route_, &pars );
+  if ((core->position[axisNo_] > hiHardLimit_ && velocity > 0) ||
+      (core->position[axisNo_] < lowHardLimit_ && velocity < 0)  ) return asynError;
 
-  time = fabs( deltaV / pars.axis[0].Amax );
+  if (acceleration != 0) core->amax[axisNo_] = fabs(acceleration);
 
-  this->endpoint_.axis[0].v = velocity;
-  this->endpoint_.axis[0].p = (this->nextpoint_.axis[0].p +
-                              time * ( this->nextpoint_.axis[0].v + 0.5 * deltaV));
-  this->reroute_ = ROUTE_NEW_ROUTE;
+  core->targetVelocity[axisNo_] = velocity;
+  core->velocityMode[axisNo_] = 1;
   return asynSuccess;
 }
 
@@ -357,7 +698,7 @@ asynStatus motorSimAxis::stop(double acceleration )
 
 asynStatus motorSimAxis::setPosition(double position)
 {
-  enc_offset_ = position - nextpoint_.axis[0].p;
+  enc_offset_ = position - pC_->core_->position[axisNo_];
   return asynSuccess;
 }
 
@@ -378,60 +719,52 @@ asynStatus motorSimAxis::poll(bool *moving)
 
 /** Process one iteration of an axis
 
-  This routine takes a single axis and propogates its motion forward a given amount
-  of time.
+  This routine takes a single axis after motorSimCoreAdvance has propogated its motion
+  forward and applies the home switch and hard limits and updates the axis status.
 
-  \param delta  [in]   Time in seconds to propogate motion forwards.
-
-  \return Integer indicating 0 (asynSuccess) for success or non-zero for failure. 
+  \param delta  [in]   Time in seconds the motion was propogated forwards.
 */
 
 void motorSimAxis::process(double delta )
 {
-  double lastpos;
+  motor_sim_core_t *core = pC_->core_;
+  double lastpos = core->lastPosition[axisNo_];
+  double position = core->position[axisNo_];
+  double velocity = core->velocity[axisNo_];
   int done = 0;
   double postMoveDelay = 0.0;
   epicsTimeStamp nowTime;
   double nowTimeSecs = 0.0;
 
-  lastpos = nextpoint_.axis[0].p;
-  nextpoint_.T += delta;
-  routeFind( route_, reroute_, &endpoint_, &nextpoint_ );
-  /*  if (reroute_ == ROUTE_NEW_ROUTE) routePrint( route_, reroute_, &endpoint_, &nextpoint_, stdout ); */
-  reroute_ = ROUTE_CALC_ROUTE;
-
   /* No, do a limits check */
   if (homing_ && 
-    ((lastpos - home_) * (nextpoint_.axis[0].p - home_)) <= 0)
+    ((lastpos - home_) * (position - home_)) <= 0)
   {
     /* Homing and have crossed the home sensor - return to home */
     homing_ = 0;
-    reroute_ = ROUTE_NEW_ROUTE;
-    endpoint_.axis[0].p = home_;
-    endpoint_.axis[0].v = 0.0;
+    core->target[axisNo_] = home_;
+    core->velocityMode[axisNo_] = 0;
   }
-  if ( nextpoint_.axis[0].p > hiHardLimit_ && nextpoint_.axis[0].v > 0 )
+  if ( position > hiHardLimit_ && velocity > 0 )
   {
-    if (homing_) setVelocity(-endpoint_.axis[0].v, 0.0 );
+    if (homing_) setVelocity(-core->targetVelocity[axisNo_], 0.0 );
     else
     {
-      reroute_ = ROUTE_NEW_ROUTE;
-      endpoint_.axis[0].p = hiHardLimit_;
-      endpoint_.axis[0].v = 0.0;
+      core->target[axisNo_] = hiHardLimit_;
+      core->velocityMode[axisNo_] = 0;
     }
   }
-  else if (nextpoint_.axis[0].p < lowHardLimit_ && nextpoint_.axis[0].v < 0)
+  else if (position < lowHardLimit_ && velocity < 0)
   {
-    if (homing_) setVelocity(-endpoint_.axis[0].v, 0.0 );
+    if (homing_) setVelocity(-core->targetVelocity[axisNo_], 0.0 );
     else
     {
-      reroute_ = ROUTE_NEW_ROUTE;
-      endpoint_.axis[0].p = lowHardLimit_;
-      endpoint_.axis[0].v = 0.0;
+      core->target[axisNo_] = lowHardLimit_;
+      core->velocityMode[axisNo_] = 0;
     }
   }
 
-  if (nextpoint_.axis[0].v ==  0) {
+  if (velocity ==  0) {
     if (!deferred_move_) {
       if (!delayedDone_) {
 	done = 1;
@@ -441,8 +774,8 @@ void motorSimAxis::process(double delta )
     done = 0;
   }
 
-  //Post move delay
-  epicsTimeGetCurrent(&nowTime);
+  //Post move delay, measured in simulated time
+  motorSimClockGetTime(&pC_->clock_, &nowTime);
   pC_->getDoubleParam(axisNo_, pC_->motorPostMoveDelay_, &postMoveDelay);
   if ((lastDone_ == 0) && (done == 1)) {
     if (postMoveDelay > 0) {
@@ -461,14 +794,14 @@ void motorSimAxis::process(double delta )
 
   lastDone_ = done;
 
-  setDoubleParam (pC_->motorPosition_,         (nextpoint_.axis[0].p+enc_offset_));
-  setDoubleParam (pC_->motorEncoderPosition_,  (nextpoint_.axis[0].p+enc_offset_));
-  setIntegerParam(pC_->motorStatusDirection_,  (nextpoint_.axis[0].v >  0));
+  setDoubleParam (pC_->motorPosition_,         (position+enc_offset_));
+  setDoubleParam (pC_->motorEncoderPosition_,  (position+enc_offset_));
+  setIntegerParam(pC_->motorStatusDirection_,  (velocity >  0));
   setIntegerParam(pC_->motorStatusDone_,       done);
-  setIntegerParam(pC_->motorStatusHighLimit_,  (nextpoint_.axis[0].p >= hiHardLimit_));
-  setIntegerParam(pC_->motorStatusHome_,       (nextpoint_.axis[0].p == home_));
+  setIntegerParam(pC_->motorStatusHighLimit_,  (position >= hiHardLimit_));
+  setIntegerParam(pC_->motorStatusHome_,       (position == home_));
   setIntegerParam(pC_->motorStatusMoving_,     !done);
-  setIntegerParam(pC_->motorStatusLowLimit_,   (nextpoint_.axis[0].p <= lowHardLimit_));
+  setIntegerParam(pC_->motorStatusLowLimit_,   (position <= lowHardLimit_));
   callParamCallbacks();
 }
 
@@ -504,6 +837,34 @@ extern "C" int motorSimConfigAxis(const char *portName, int axis, int hiHardLimi
   return(-1);
 }
 
+/** Enables profile moves on a controller and sets the servo model used to execute them */
+extern "C" int motorSimConfigProfile(const char *portName, int maxPoints, double servoLag, double noise, double sampleRate)
+{
+  motorSimControllerNode *pNode;
+  static const char *functionName = "motorSimConfigProfile";
+
+  if (!motorSimControllerListInitialized) {
+    printf("%s:%s: ERROR, controller list not initialized\n",
+      driverName, functionName);
+    return(-1);
+  }
+  if (maxPoints < 2) {
+    printf("%s:%s: ERROR, maxPoints=%d must be at least 2\n",
+      driverName, functionName, maxPoints);
+    return(-1);
+  }
+  pNode = (motorSimControllerNode*)ellFirst(&motorSimControllerList);
+  while(pNode) {
+    if (strcmp(pNode->portName, portName) == 0) {
+      pNode->pController->configProfile(maxPoints, servoLag, noise, sampleRate);
+      return(0);
+    }
+    pNode = (motorSimControllerNode*)ellNext((ELLNODE*)pNode);
+  }
+  printf("Controller not found\n");
+  return(-1);
+}
+
 /** Code for iocsh registration */
 static const iocshArg motorSimCreateControllerArg0 = {"Port name", iocshArgString};
 static const iocshArg motorSimCreateControllerArg1 = {"Number of axes", iocshArgInt};
@@ -541,11 +902,32 @@ static void motorSimConfigAxisCallFunc(const iocshArgBuf *args)
   motorSimConfigAxis(args[0].sval, args[1].ival, args[2].ival, args[3].ival, args[4].ival, args[5].ival);
 }
 
+static const iocshArg motorSimConfigProfileArg0 = { "Port name",   iocshArgString};
+static const iocshArg motorSimConfigProfileArg1 = { "Max points",  iocshArgInt};
+static const iocshArg motorSimConfigProfileArg2 = { "Servo lag",   iocshArgDouble};
+static const iocshArg motorSimConfigProfileArg3 = { "Noise",       iocshArgDouble};
+static const iocshArg motorSimConfigProfileArg4 = { "Sample rate", iocshArgDouble};
+
+static const iocshArg *const motorSimConfigProfileArgs[] = {
+  &motorSimConfigProfileArg0,
+  &motorSimConfigProfileArg1,
+  &motorSimConfigProfileArg2,
+  &motorSimConfigProfileArg3,
+  &motorSimConfigProfileArg4
+};
+static const iocshFuncDef motorSimConfigProfileDef ={"motorSimConfigProfile",5,motorSimConfigProfileArgs};
+
+static void motorSimConfigProfileCallFunc(const iocshArgBuf *args)
+{
+  motorSimConfigProfile(args[0].sval, args[1].ival, args[2].dval, args[3].dval, args[4].dval);
+}
+
 static void motorSimDriverRegister(void)
 {
 
   iocshRegister(&motorSimCreateControllerDef, motorSimCreateContollerCallFunc);
   iocshRegister(&motorSimConfigAxisDef, motorSimConfigAxisCallFunc);
+  iocshRegister(&motorSimConfigProfileDef, motorSimConfigProfileCallFunc);
 }
 
 extern "C" {
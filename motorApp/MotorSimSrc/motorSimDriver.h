@@ -15,9 +15,18 @@ March 28, 2010
 
 #include "asynMotorController.h"
 #include "asynMotorAxis.h"
-#include "route.h"
+#include "motorSimCore.h"
+#include "motorSimClock.h"
 
 #define NUM_SIM_CONTROLLER_PARAMS 0
+#define MAX_MESSAGE_LEN 256
+
+/* States of the simulated profile move, advanced by motorSimTask */
+typedef enum {
+  SIM_PROFILE_IDLE,
+  SIM_PROFILE_MOVE_START,
+  SIM_PROFILE_EXECUTING
+} simProfileState_t;
 
 class epicsShareClass motorSimAxis : public asynMotorAxis
 {
@@ -31,6 +40,7 @@ public:
   asynStatus stop(double acceleration);
   asynStatus poll(bool *moving);
   asynStatus setPosition(double position);
+  asynStatus initializeProfile(size_t maxPoints);
 
   /* These are the methods that are new to this class */
   asynStatus config(int hiHardLimit, int lowHardLimit, int home, int start);
@@ -39,10 +49,6 @@ public:
 
 private:
   motorSimController *pC_;
-  ROUTE_ID route_;
-  route_reroute_t reroute_;
-  route_demand_t endpoint_;
-  route_demand_t nextpoint_;
   double lowHardLimit_;
   double hiHardLimit_;
   double enc_offset_;
@@ -55,6 +61,11 @@ private:
   double lastTimeSecs_;
   int delayedDone_;
   int lastDone_;
+  int profileInUse_;                 /**< Axis takes part in the current profile move */
+  double profileOffset_;             /**< Added to the profile positions, non-zero in relative mode */
+  double *profileVelocities_;        /**< Velocity at each profile point, computed by buildProfile */
+  double *gatherReadbacks_;          /**< Gathered actual positions of the last profile execution */
+  double *gatherErrors_;             /**< Gathered following errors of the last profile execution */
   
 friend class motorSimController;
 };
@@ -70,15 +81,38 @@ public:
   motorSimAxis* getAxis(int axisNo);
   asynStatus profileMove(asynUser *pasynUser, int npoints, double positions[], double times[], int relative, int trigger);
   asynStatus triggerProfile(asynUser *pasynUser);
+  asynStatus initializeProfile(size_t maxPoints);
+  asynStatus buildProfile();
+  asynStatus executeProfile();
+  asynStatus abortProfile();
+  asynStatus readbackProfile();
 
   /* These are the functions that are new to this class */
   void motorSimTask();  // Should be pivate, but called from non-member function
+  asynStatus configProfile(size_t maxPoints, double servoLag, double noise, double sampleRate);
 
 private:
   asynStatus processDeferredMoves();
+  void profileStep(double delta);
+  double profileSetpoint(motorSimAxis *pAxis, double time, int *segment);
+  double profileSampleTime(int sample);
+  double profileNoise();
+  motor_sim_core_t *core_;
   epicsThreadId motorThread_;
-  epicsTimeStamp prevTime_;
+  motor_sim_clock_t clock_;
   int movesDeferred_;
+  double *simProfileTimes_;      /**< Time of each profile point from the start of the profile */
+  int simProfileNumPoints_;      /**< Number of points in the built profile, 0 if not built */
+  simProfileState_t simProfileState_;
+  double simProfileStart_;       /**< Simulated time at which the profile started executing */
+  double simServoLag_;           /**< Time in seconds that the axes lag behind the setpoint */
+  double simNoise_;              /**< Standard deviation of the readback noise in controller units */
+  double simSampleRate_;         /**< Gathering rate in Hz, 0 to gather once per profile point */
+  int simNumSamples_;            /**< Number of samples gathered so far */
+  int simMotionSegment_;         /**< Segment cursors for the three monotonic time sequences */
+  int simSampleSegment_;
+  int simLagSegment_;
+  unsigned int simNoiseSeed_;
   
 friend class motorSimAxis;
 };
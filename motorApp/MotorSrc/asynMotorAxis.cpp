@@ -44,6 +44,7 @@ asynMotorAxis::asynMotorAxis(class asynMotorController *pC, int axisNo)
   }
   pC->pAxes_[axisNo] = this;
   status_.status = 0;
+  statusCallbackPending_ = 0;
   profilePositions_       = NULL;
   profileReadbacks_       = NULL;
   profileFollowingErrors_ = NULL;
@@ -57,6 +58,14 @@ asynMotorAxis::asynMotorAxis(class asynMotorController *pC, int axisNo)
   disableFlag_ = 0;
   lastEndOfMoveTime_ = 0;
 
+  moveType_ = moveTypeNone;
+  moveTarget_ = 0.;
+  moveVelocity_ = 0.;
+  moveAcceleration_ = 0.;
+  nextPollTime_ = 0.;
+  pollGroup_ = 0;
+  lastPollStatus_ = 0;
+
   // Create the asynUser, connect to this axis
   pasynUser_ = pasynManager->createAsynUser(NULL, NULL);
   pasynManager->connectDevice(pasynUser_, pC->portName, axisNo);
@@ -302,12 +311,19 @@ asynStatus asynMotorAxis::setStringParam(int function, const char *value)
 
 /** Calls the callbacks for any parameters that have changed for this axis in the parameter library.
   * This function takes special action if the aggregate MotorStatus structure has changed.
-  * In that case it does callbacks on the asynGenericPointer interface, typically to devMotorAsyn. */  
+  * In that case it does callbacks on the asynGenericPointer interface, typically to devMotorAsyn.
+  * If coalesced status callbacks are enabled the callback is left for the poller to do 
+  * at the end of its poll cycle. */  
 asynStatus asynMotorAxis::callParamCallbacks()
 {
   if (statusChanged_) {
     statusChanged_ = 0;
-    pC_->doCallbacksGenericPointer((void *)&status_, pC_->motorStatus_, axisNo_);
+    if (pC_->coalesceStatusCallbacks_) {
+      statusCallbackPending_ = 1;
+      if (!pC_->pollCycleActive_) pC_->wakeupPoller();
+    } else {
+      pC_->doCallbacksGenericPointer((void *)&status_, pC_->motorStatus_, axisNo_);
+    }
   }
   return pC_->callParamCallbacks(axisNo_);
 }
@@ -418,10 +434,12 @@ asynStatus asynMotorAxis::readbackProfile()
   int status=0;
   //static const char *functionName = "readbackProfile";
 
+  pC_->lock();
   status |= pC_->getDoubleParam(axisNo_, pC_->motorRecResolution_, &resolution);
   status |= pC_->getDoubleParam(axisNo_, pC_->motorRecOffset_, &offset);
   status |= pC_->getIntegerParam(axisNo_, pC_->motorRecDirection_, &direction);
   status |= pC_->getIntegerParam(0, pC_->profileNumReadbacks_, &numReadbacks);
+  pC_->unlock();
   if (status) return asynError;
   
   // Convert to user units
@@ -430,8 +448,10 @@ asynStatus asynMotorAxis::readbackProfile()
     profileReadbacks_[i] = profileReadbacks_[i] * resolution + offset;
     profileFollowingErrors_[i] = profileFollowingErrors_[i] * resolution;
   }
+  pC_->lock();
   status  = pC_->doCallbacksFloat64Array(profileReadbacks_,       numReadbacks, pC_->profileReadbacks_, axisNo_);
   status |= pC_->doCallbacksFloat64Array(profileFollowingErrors_, numReadbacks, pC_->profileFollowingErrors_, axisNo_);
+  pC_->unlock();
   return asynSuccess;
 }
 
@@ -488,6 +508,22 @@ void asynMotorAxis::setLastEndOfMoveTime(double time)
   lastEndOfMoveTime_ = time;
 }
 
+/**
+ * Record the target of a new move.  This is used by the adaptive poller
+ * to predict when the move will finish.
+ * \param[in] type The kind of move.
+ * \param[in] target The target position for moveTypePosition. Units=steps.
+ * \param[in] velocity The velocity of the move. Units=steps/sec.
+ * \param[in] acceleration The acceleration of the move. Units=steps/sec/sec.
+ */
+void asynMotorAxis::setMoveTarget(moveType type, double target, double velocity, double acceleration)
+{
+  moveType_ = type;
+  moveTarget_ = target;
+  moveVelocity_ = velocity;
+  moveAcceleration_ = acceleration;
+}
+
 
 /********************************************************************/
 
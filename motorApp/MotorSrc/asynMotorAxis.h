@@ -20,6 +20,13 @@
 class epicsShareClass asynMotorAxis {
 
   public:
+  /** The kinds of move, used to predict when a move will finish for adaptive polling */
+  enum moveType {
+    moveTypeNone,      /**< No move, or a move with no known target, e.g. home */
+    moveTypePosition,  /**< Absolute or relative move to moveTarget_ */
+    moveTypeVelocity   /**< Jog at moveVelocity_ */
+  };
+
   /* This is the constructor for the class. */
   asynMotorAxis(class asynMotorController *pController, int axisNumber);
   virtual ~asynMotorAxis();
@@ -62,6 +69,7 @@ class epicsShareClass asynMotorAxis {
   void setDisableFlag(int disableFlag);
   double getLastEndOfMoveTime();
   void setLastEndOfMoveTime(double time);
+  void setMoveTarget(moveType type, double target, double velocity, double acceleration);
 
   protected:
   class asynMotorController *pC_;    /**< Pointer to the asynMotorController to which this axis belongs.
@@ -75,12 +83,22 @@ class epicsShareClass asynMotorAxis {
 
   MotorStatus status_;
   int statusChanged_;
+  int statusCallbackPending_;        /**< MotorStatus callback deferred until the end of the poll cycle */
 
   private:
   int referencingModeMove_;
   int wasMovingFlag_;
   int disableFlag_;
   double lastEndOfMoveTime_;
+
+  /* These are used by the adaptive poller */
+  moveType moveType_;
+  double moveTarget_;
+  double moveVelocity_;
+  double moveAcceleration_;
+  double nextPollTime_;
+  int pollGroup_;
+  epicsUInt32 lastPollStatus_;
   
   friend class asynMotorController;
 };
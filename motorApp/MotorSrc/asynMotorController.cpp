@@ -7,8 +7,10 @@
  */
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
 #include <epicsThread.h>
+#include <epicsExit.h>
 #include <iocsh.h>
 
 #include <asynPortDriver.h>
@@ -22,6 +24,8 @@
 static const char *driverName = "asynMotorController";
 static void asynMotorPollerC(void *drvPvt);
 static void asynMotorMoveToHomeC(void *drvPvt);
+static void asynMotorProfileJobsC(void *drvPvt);
+static void asynMotorShutdownC(void *drvPvt);
 
 
 
@@ -127,11 +131,26 @@ asynMotorController::asynMotorController(const char *portName, int numAxes, int
   createParam(profileFollowingErrorsString, asynParamFloat64Array,    &profileFollowingErrors_);
 
   pAxes_ = (asynMotorAxis**) calloc(numAxes, sizeof(asynMotorAxis*));
+  pollMoving_ = (bool *) calloc(numAxes, sizeof(bool));
+  pollAxes_ = (asynMotorAxis**) calloc(numAxes, sizeof(asynMotorAxis*));
+  pollAxesMoving_ = (bool *) calloc(numAxes, sizeof(bool));
+  pollerStarted_ = false;
+  maxMovingPollPeriod_ = 0.;
+  coalesceStatusCallbacks_ = 0;
+  pollCycleActive_ = 0;
+  pendingStatus_ = (MotorStatus *) calloc(numAxes, sizeof(MotorStatus));
+  pendingStatusAxes_ = (int *) calloc(numAxes, sizeof(int));
+  numPollGroups_ = 0;
+  for (int group=0; group<MAX_POLL_GROUPS; group++) {
+    pollGroupMovingPeriod_[group] = 0.;
+    pollGroupIdlePeriod_[group] = 0.;
+  }
   pollEventId_ = epicsEventMustCreate(epicsEventEmpty);
   moveToHomeId_ = epicsEventMustCreate(epicsEventEmpty);
 
   maxProfilePoints_ = 0;
   profileTimes_ = NULL;
+  profileJobQueue_ = NULL;
   setIntegerParam(profileExecuteState_, PROFILE_EXECUTE_DONE);
 
   moveToHomeAxis_ = 0;
@@ -196,6 +215,11 @@ asynStatus asynMotorController::writeInt32(asynUser *pasynUser, epicsInt32 value
     double accel;
     getDoubleParam(axis, motorAccel_, &accel);
     status = pAxis->stop(accel);
+    /* The move target no longer applies, and the axis must be polled now rather than at
+     * the period predicted from the target, so the end of the stop is seen promptly */
+    pAxis->setMoveTarget(asynMotorAxis::moveTypeNone, 0., 0., accel);
+    pAxis->nextPollTime_ = 0.;
+    wakeupPoller();
   
   } else if (function == motorDeferMoves_) {
     status = setDeferredMoves(value);
@@ -210,18 +234,19 @@ asynStatus asynMotorController::writeInt32(asynUser *pasynUser, epicsInt32 value
     status = pAxis->poll(&moving);
     pAxis->statusChanged_ = 1;
 
-  } else if (function == profileBuild_) {
-    status = buildProfile();
-
-  } else if (function == profileExecute_) {
-    status = executeProfile();
+  } else if ((function == profileBuild_) ||
+             (function == profileExecute_) ||
+             (function == profileReadback_)) {
+    /* Run in the profile thread, so this port is not blocked while a profile is
+     * built, executed or read back */
+    if (profileJobQueue_) status = queueProfileJob(function);
+    else if (function == profileBuild_) status = buildProfile();
+    else if (function == profileExecute_) status = executeProfile();
+    else status = readbackProfile();
 
   } else if (function == profileAbort_) {
     status = abortProfile();
 
-  } else if (function == profileReadback_) {
-    status = readbackProfile();
-
   } else if (function == motorMoveToHome_) {
     if (value == 1) {
       asynPrint(pasynUser, ASYN_TRACE_FLOW, 
@@ -262,6 +287,7 @@ asynStatus asynMotorController::writeFloat64(asynUser *pasynUser, epicsFloat64 v
   asynMotorAxis *pAxis;
   int axis;
   int forwards;
+  double position;
   int autoPower = 0;
   double autoPowerOnDelay = 0.0;
   asynStatus status = asynError;
@@ -285,6 +311,8 @@ asynStatus asynMotorController::writeFloat64(asynUser *pasynUser, epicsFloat64 v
     getDoubleParam(axis, motorVelBase_, &baseVelocity);
     getDoubleParam(axis, motorVelocity_, &velocity);
     getDoubleParam(axis, motorAccel_, &acceleration);
+    getDoubleParam(axis, motorPosition_, &position);
+    pAxis->setMoveTarget(asynMotorAxis::moveTypePosition, position + value, velocity, acceleration);
     status = pAxis->move(value, 1, baseVelocity, velocity, acceleration);
     pAxis->setIntegerParam(motorStatusDone_, 0);
     pAxis->callParamCallbacks();
@@ -301,6 +329,7 @@ asynStatus asynMotorController::writeFloat64(asynUser *pasynUser, epicsFloat64 v
     getDoubleParam(axis, motorVelBase_, &baseVelocity);
     getDoubleParam(axis, motorVelocity_, &velocity);
     getDoubleParam(axis, motorAccel_, &acceleration);
+    pAxis->setMoveTarget(asynMotorAxis::moveTypePosition, value, velocity, acceleration);
     status = pAxis->move(value, 0, baseVelocity, velocity, acceleration);
     pAxis->setIntegerParam(motorStatusDone_, 0);
     pAxis->callParamCallbacks();
@@ -316,6 +345,7 @@ asynStatus asynMotorController::writeFloat64(asynUser *pasynUser, epicsFloat64 v
     }
     getDoubleParam(axis, motorVelBase_, &baseVelocity);
     getDoubleParam(axis, motorAccel_, &acceleration);
+    pAxis->setMoveTarget(asynMotorAxis::moveTypeVelocity, 0., value, acceleration);
     status = pAxis->moveVelocity(baseVelocity, value, acceleration);
     pAxis->setIntegerParam(motorStatusDone_, 0);
     pAxis->callParamCallbacks();
@@ -334,6 +364,7 @@ asynStatus asynMotorController::writeFloat64(asynUser *pasynUser, epicsFloat64 v
     getDoubleParam(axis, motorVelocity_, &velocity);
     getDoubleParam(axis, motorAccel_, &acceleration);
     forwards = (value == 0) ? 0 : 1;
+    pAxis->setMoveTarget(asynMotorAxis::moveTypeNone, 0., velocity, acceleration);
     status = pAxis->home(baseVelocity, velocity, acceleration, forwards);
     pAxis->setIntegerParam(motorStatusDone_, 0);
     pAxis->callParamCallbacks();
@@ -554,6 +585,7 @@ asynStatus asynMotorController::startPoller(double movingPollPeriod, double idle
   movingPollPeriod_ = movingPollPeriod;
   idlePollPeriod_   = idlePollPeriod;
   forcedFastPolls_  = forcedFastPolls;
+  pollerStarted_    = true;
   epicsThreadCreate("motorPoller", 
                     epicsThreadPriorityLow,
                     epicsThreadGetStackSize(epicsThreadStackMedium),
@@ -584,28 +616,142 @@ asynStatus asynMotorController::poll()
   return asynSuccess;
 }
 
+/** Polls a set of axes on this controller.
+  * The base class asynMotorPoller thread calls this method once per poll cycle, just after it
+  * calls asynMotorController::poll().
+  * This base class implementation simply calls asynMotorAxis::poll() for each axis in turn.
+  * Derived classes can reimplement this method if the controller can return the status of
+  * several axes in a single transaction.  In that case the derived class should issue that
+  * transaction here, set the parameters for each axis, call asynMotorAxis::callParamCallbacks()
+  * for each axis, and fill in the moving flags.  This avoids one round trip per axis per poll.
+  * \param[in] pAxes Array of pointers to the axes to poll.  Entries may be NULL.
+  * \param[in] numAxes Number of entries in pAxes.
+  * \param[out] moving Array of numAxes flags that the function must set to indicate that
+  *             the corresponding axis is moving (true) or done (false). */
+asynStatus asynMotorController::pollAll(asynMotorAxis **pAxes, int numAxes, bool *moving)
+{
+  int i;
+  asynStatus status = asynSuccess;
+
+  for (i=0; i<numAxes; i++) {
+    moving[i] = false;
+    if (!pAxes[i]) continue;
+    if (pAxes[i]->poll(&moving[i]) != asynSuccess) status = asynError;
+  }
+  return status;
+}
+
 static void asynMotorPollerC(void *drvPvt)
 {
   asynMotorController *pController = (asynMotorController*)drvPvt;
   pController->asynMotorPoller();
 }
   
+/** Returns the time until an axis should next be polled when adaptive polling is enabled.
+  * This is called by the poller after each poll of the axis if setMaxMovingPollPeriod() has been
+  * called with a non-zero period.
+  * It is also called when poll groups have been defined with setPollGroupPeriods(), in which case
+  * the moving and idle poll periods are those of the axis's poll group, and if adaptive polling is
+  * not enabled moving axes are polled at the moving poll period of their group.
+  * Axes that are not moving are polled at the idlePollPeriod_.  Axes that have just changed
+  * state, or whose target is unknown (e.g. homing), are polled at the movingPollPeriod_.
+  * Otherwise the time to reach the target of the move (or the soft limit for a jog) is predicted
+  * from the position, velocity and acceleration, and the axis is polled after a fraction of that
+  * time, so that axes far from the end of a long move are polled slowly and axes about to finish
+  * are polled at the movingPollPeriod_.  The result is limited to the range movingPollPeriod_ to
+  * maxMovingPollPeriod_.
+  * The prediction only knows about moves commanded through this driver.  A stop commanded by
+  * this driver resets the move target and wakes up the poller, but a move that ends early for
+  * any other reason, e.g. a stop from the controller front panel, a limit switch or a fault,
+  * is only seen at the next predicted poll, up to maxMovingPollPeriod_ later.
+  * Derived classes can reimplement this if they have a better estimate of the time to complete the move.
+  * \param[in] pAxis The axis that has just been polled.
+  * \param[in] moving Flag indicating that the axis is moving. */
+double asynMotorController::adaptivePollPeriod(asynMotorAxis *pAxis, bool moving)
+{
+  double position, highLimit, lowLimit;
+  double distance = -1.0;
+  double velocity = fabs(pAxis->moveVelocity_);
+  double remaining, period;
+  double movingPollPeriod = getPollGroupMovingPeriod(pAxis->pollGroup_);
+  bool changed;
+
+  changed = (pAxis->status_.status != pAxis->lastPollStatus_);
+  pAxis->lastPollStatus_ = pAxis->status_.status;
+  if (!moving) return getPollGroupIdlePeriod(pAxis->pollGroup_);
+  if (changed || (velocity <= 0.) || (maxMovingPollPeriod_ <= 0.)) return movingPollPeriod;
+
+  getDoubleParam(pAxis->axisNo_, motorPosition_, &position);
+  if (pAxis->moveType_ == asynMotorAxis::moveTypePosition) {
+    distance = fabs(pAxis->moveTarget_ - position);
+  } else if (pAxis->moveType_ == asynMotorAxis::moveTypeVelocity) {
+    getDoubleParam(pAxis->axisNo_, motorHighLimit_, &highLimit);
+    getDoubleParam(pAxis->axisNo_, motorLowLimit_, &lowLimit);
+    if (highLimit > lowLimit) {
+      distance = (pAxis->moveVelocity_ > 0.) ? highLimit - position : position - lowLimit;
+      if (distance < 0.) distance = 0.;
+    }
+  }
+  if (distance < 0.) return movingPollPeriod;
+
+  /* Time to reach the target at constant velocity, plus the extra time to decelerate */
+  remaining = distance/velocity;
+  if (pAxis->moveAcceleration_ > 0.) remaining += velocity/(2.*pAxis->moveAcceleration_);
+  period = remaining * ADAPTIVE_POLL_FRACTION;
+  if (period > maxMovingPollPeriod_) period = maxMovingPollPeriod_;
+  if (period < movingPollPeriod)     period = movingPollPeriod;
+  return period;
+}
+
+/** Returns the moving poll period of a poll group.  Group 0, and groups whose periods have not
+  * been set with setPollGroupPeriods(), use the controller's movingPollPeriod_.
+  * \param[in] group The poll group number. */
+double asynMotorController::getPollGroupMovingPeriod(int group)
+{
+  if ((group <= 0) || (group >= MAX_POLL_GROUPS) || (pollGroupMovingPeriod_[group] <= 0.)) return movingPollPeriod_;
+  return pollGroupMovingPeriod_[group];
+}
+
+/** Returns the idle poll period of a poll group.  Group 0, and groups whose periods have not
+  * been set with setPollGroupPeriods(), use the controller's idlePollPeriod_.
+  * \param[in] group The poll group number. */
+double asynMotorController::getPollGroupIdlePeriod(int group)
+{
+  if ((group <= 0) || (group >= MAX_POLL_GROUPS) || (pollGroupMovingPeriod_[group] <= 0.)) return idlePollPeriod_;
+  return pollGroupIdlePeriod_[group];
+}
+
 /** Default poller function that runs in the thread created by asynMotorController::startPoller().
   * This base class implementation can be used by most derived classes. 
   * It polls at the idlePollPeriod_ when no axes are moving, and at the movingPollPeriod_ when
   * any axis is moving.  It will immediately do a poll when asynMotorController::wakeupPoller() is
   * called, and will then do forcedFastPolls_ loops at the movingPollPeriod, before reverting back
   * to the idlePollPeriod_ if no axes are moving. It takes the lock on the port driver when it is polling.
+  * The axes are polled with a single call to asynMotorController::pollAll(), so derived classes
+  * can batch the status requests for all axes.
+  * If coalesced status callbacks have been enabled with setCoalescedStatusCallbacks() then the
+  * MotorStatus callbacks to devMotorAsyn for all axes that changed during the poll cycle are done
+  * together after the lock has been released.
+  * If adaptive polling has been enabled with setMaxMovingPollPeriod(), or poll groups have been
+  * defined with setPollGroupPeriods(), then each axis has its own next poll time, computed by
+  * adaptivePollPeriod(), and only the axes that are due are polled.  This means that a moving
+  * axis does not cause the idle axes in other poll groups to be polled fast.
   */
 void asynMotorController::asynMotorPoller()
 {
   double timeout;
   int i;
+  int numPoll;
   int forcedFastPolls=0;
+  int numPending;
   bool anyMoving;
   bool moving;
+  bool pollAllAxes;
+  bool perAxisPoll;
+  double minPollPeriod;
   epicsTimeStamp nowTime;
   double nowTimeSecs = 0.0;
+  double pollTime;
   asynMotorAxis *pAxis;
   int autoPower = 0;
   double autoPowerOffDelay = 0.0;
@@ -631,8 +777,39 @@ void asynMotorController::asynMotorPoller()
       unlock();
       break;
     }
+    pollCycleActive_ = 1;
 
+    epicsTimeGetCurrent(&nowTime);
+    nowTimeSecs = nowTime.secPastEpoch + (nowTime.nsec / 1.e9);
     poll();
+
+    /* Select the axes to poll.  All axes are polled unless adaptive polling is enabled,
+     * in which case only the axes whose next poll time has arrived are polled. */
+    perAxisPoll = (maxMovingPollPeriod_ > 0.) || (numPollGroups_ > 0);
+    pollAllAxes = !perAxisPoll || (status == epicsEventWaitOK) || (forcedFastPolls > 0);
+    minPollPeriod = movingPollPeriod_;
+    for (i=1; i<numPollGroups_; i++) {
+      if ((pollGroupMovingPeriod_[i] > 0.) && (pollGroupMovingPeriod_[i] < minPollPeriod)) 
+        minPollPeriod = pollGroupMovingPeriod_[i];
+    }
+    numPoll = 0;
+    for (i=0; i<numAxes_; i++) {
+      pAxis=getAxis(i);
+      if (!pAxis) continue;
+      if (!pollAllAxes && (pAxis->nextPollTime_ - nowTimeSecs > minPollPeriod/2.)) continue;
+      pollAxes_[numPoll++] = pAxis;
+    }
+    pollAll(pollAxes_, numPoll, pollAxesMoving_);
+    for (i=0; i<numPoll; i++) {
+      pAxis = pollAxes_[i];
+      pollMoving_[pAxis->axisNo_] = pollAxesMoving_[i];
+      if (perAxisPoll) {
+        pollTime = adaptivePollPeriod(pAxis, pollAxesMoving_[i]);
+        /* An idle period of 0 means only poll when woken up */
+        pAxis->nextPollTime_ = (pollTime > 0.) ? nowTimeSecs + pollTime : ADAPTIVE_POLL_NEVER;
+      }
+    }
+
     for (i=0; i<numAxes_; i++) {
       pAxis=getAxis(i);
       if (!pAxis) continue;
@@ -640,7 +817,7 @@ void asynMotorController::asynMotorPoller()
       getIntegerParam(i, motorPowerAutoOnOff_, &autoPower);
       getDoubleParam(i, motorPowerOffDelay_, &autoPowerOffDelay);
       
-      pAxis->poll(&moving);
+      moving = pollMoving_[i];
       if (moving) {
 	anyMoving = true;
 	pAxis->setWasMovingFlag(1);
@@ -671,12 +848,42 @@ void asynMotorController::asynMotorPoller()
     if (forcedFastPolls > 0) {
       timeout = movingPollPeriod_;
       forcedFastPolls--;
+    } else if (perAxisPoll) {
+      /* Sleep until the next axis is due to be polled */
+      epicsTimeGetCurrent(&nowTime);
+      nowTimeSecs = nowTime.secPastEpoch + (nowTime.nsec / 1.e9);
+      timeout = idlePollPeriod_;
+      for (i=0; i<numAxes_; i++) {
+        pAxis=getAxis(i);
+        if (!pAxis || (pAxis->nextPollTime_ >= ADAPTIVE_POLL_NEVER)) continue;
+        pollTime = pAxis->nextPollTime_ - nowTimeSecs;
+        if ((timeout == 0.) || (pollTime < timeout)) timeout = pollTime;
+      }
+      if ((timeout != 0.) && (timeout < minPollPeriod)) timeout = minPollPeriod;
     } else if (anyMoving) {
       timeout = movingPollPeriod_;
     } else {
       timeout = idlePollPeriod_;
     }
+
+    /* Collect the MotorStatus callbacks that were deferred by asynMotorAxis::callParamCallbacks() */
+    numPending = 0;
+    for (i=0; i<numAxes_; i++) {
+      pAxis=getAxis(i);
+      if (!pAxis || !pAxis->statusCallbackPending_) continue;
+      pAxis->statusCallbackPending_ = 0;
+      pendingStatus_[numPending] = pAxis->status_;
+      pendingStatusAxes_[numPending++] = i;
+    }
+    pollCycleActive_ = 0;
     unlock();
+
+    /* Do the callbacks without holding the lock, so record processing does not
+     * wait for or block the poller.  Only this thread does deferred callbacks, so
+     * they are delivered in order. */
+    for (i=0; i<numPending; i++) {
+      doCallbacksGenericPointer((void *)&pendingStatus_[i], motorStatus_, pendingStatusAxes_[i]);
+    }
   }
 }
 
@@ -783,13 +990,25 @@ asynStatus asynMotorController::writeReadController(const char *output, char *in
 
 
 /* These are the functions for profile moves */
-/** Initialize a profile move of multiple axes. */
+/** Initialize a profile move of multiple axes.
+  * This also starts the profile thread, which calls buildProfile(), executeProfile() and
+  * readbackProfile() in the order they are requested.  See asynMotorProfileJobs(). */
 asynStatus asynMotorController::initializeProfile(size_t maxProfilePoints)
 {
   int axis;
   asynMotorAxis *pAxis;
   // static const char *functionName = "initializeProfile";
   
+  if (!profileJobQueue_) {
+    profileJobQueue_ = epicsMessageQueueCreate(MAX_PROFILE_JOBS, sizeof(int));
+    if (profileJobQueue_) {
+      epicsThreadCreate("motorProfile", 
+                        epicsThreadPriorityMedium,
+                        epicsThreadGetStackSize(epicsThreadStackMedium),
+                        (EPICSTHREADFUNC)asynMotorProfileJobsC, (void *)this);
+      epicsAtExit(asynMotorShutdownC, this);
+    }
+  }
   maxProfilePoints_ = maxProfilePoints;
   if (profileTimes_) free(profileTimes_);
   profileTimes_ = (double *)calloc(maxProfilePoints, sizeof(double));
@@ -801,6 +1020,99 @@ asynStatus asynMotorController::initializeProfile(size_t maxProfilePoints)
   return asynSuccess;
 }
   
+/** Passes a profile build, execute or readback request to the profile thread.
+  * \param[in] function The parameter that was written, profileBuild_, profileExecute_ or profileReadback_. */
+asynStatus asynMotorController::queueProfileJob(int function)
+{
+  static const char *functionName = "queueProfileJob";
+
+  if (epicsMessageQueueTrySend(profileJobQueue_, &function, sizeof(function)) != 0) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: too many profile requests pending, function=%d\n",
+      driverName, functionName, function);
+    return asynError;
+  }
+  return asynSuccess;
+}
+
+static void asynMotorProfileJobsC(void *drvPvt)
+{
+  asynMotorController *pController = (asynMotorController*)drvPvt;
+  pController->asynMotorProfileJobs();
+}
+
+/** Profile thread, started by initializeProfile().
+  * Runs the profile requests queued by writeInt32() one at a time.  buildProfile(), executeProfile()
+  * and readbackProfile() are called with the lock held, unless profileHooksUnlocked() returns true.
+  * If a request fails the PROFILE_BUILD, PROFILE_EXECUTE or PROFILE_READBACK parameter is reset
+  * to 0, so the busy record that started it does not stay busy.
+  * The thread exits when shutdown() posts its wakeup job. */
+void asynMotorController::asynMotorProfileJobs()
+{
+  int function;
+  bool unlocked;
+  asynStatus status;
+  static const char *functionName = "asynMotorProfileJobs";
+
+  while (1) {
+    if (epicsMessageQueueReceive(profileJobQueue_, &function, sizeof(function)) < 0) continue;
+    lock();
+    if (shuttingDown_) {
+      unlock();
+      break;
+    }
+    if (function == PROFILE_JOB_WAKEUP) {
+      unlock();
+      continue;
+    }
+    unlocked = profileHooksUnlocked();
+    if (unlocked) unlock();
+    if (function == profileBuild_)        status = buildProfile();
+    else if (function == profileExecute_) status = executeProfile();
+    else                                  status = readbackProfile();
+    if (unlocked) lock();
+    if (status) {
+      asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+        "%s:%s: error, status=%d function=%d\n",
+        driverName, functionName, status, function);
+      setIntegerParam(function, 0);
+    }
+    callParamCallbacks();
+    unlock();
+  }
+}
+
+/** Returns true if the profile thread should call buildProfile(), executeProfile() and readbackProfile()
+  * without the lock.
+  * This base class implementation returns false, so the hooks are called with the lock held.  Derived
+  * classes whose hooks block on the controller for a long time can return true, so that the poller and
+  * the other records on this port keep running; their hooks must then call lock() and unlock() around
+  * access to the parameter library and to other data shared with the port thread. */
+bool asynMotorController::profileHooksUnlocked()
+{
+  return false;
+}
+
+static void asynMotorShutdownC(void *drvPvt)
+{
+  asynMotorController *pController = (asynMotorController*)drvPvt;
+  pController->shutdown();
+}
+
+/** Called at IOC exit.
+  * Sets shuttingDown_, which stops the poller, and wakes up the poller and the profile thread
+  * so that they see it and exit.  Derived classes that override this must call it. */
+void asynMotorController::shutdown()
+{
+  int function = PROFILE_JOB_WAKEUP;
+
+  lock();
+  shuttingDown_ = 1;
+  unlock();
+  if (profileJobQueue_) epicsMessageQueueTrySend(profileJobQueue_, &function, sizeof(function));
+  wakeupPoller();
+}
+
 /** Build a profile move of multiple axes. */
 asynStatus asynMotorController::buildProfile()
 {
@@ -812,10 +1124,14 @@ asynStatus asynMotorController::buildProfile()
   int timeMode;
   int numPoints;
 
+  lock();
   status |= getIntegerParam(profileTimeMode_, &timeMode);
   status |= getDoubleParam(profileFixedTime_, &time);
   status |= getIntegerParam(profileNumPoints_, &numPoints);
-  if (status) return asynError;
+  if (status) {
+    unlock();
+    return asynError;
+  }
   if (timeMode == PROFILE_TIME_MODE_FIXED) {
     memset(profileTimes_, 0, maxProfilePoints_*sizeof(double));
     for (i=0; i<numPoints; i++) {
@@ -827,6 +1143,7 @@ asynStatus asynMotorController::buildProfile()
     if (!pAxis) continue;
     pAxis->buildProfile();
   }
+  unlock();
   return asynSuccess;
 }
 
@@ -837,11 +1154,13 @@ asynStatus asynMotorController::executeProfile()
   int axis;
   asynMotorAxis *pAxis;
   
+  lock();
   for (axis=0; axis<numAxes_; axis++) {
     pAxis = getAxis(axis);
     if (!pAxis) continue;
     pAxis->executeProfile();
   }
+  unlock();
   return asynSuccess;
 }
 
@@ -867,11 +1186,13 @@ asynStatus asynMotorController::readbackProfile()
   int axis;
   asynMotorAxis *pAxis;
   
+  lock();
   for (axis=0; axis<numAxes_; axis++) {
     pAxis = getAxis(axis);
     if (!pAxis) continue;
     pAxis->readbackProfile();
   }
+  unlock();
   return asynSuccess;
 }
 
@@ -907,6 +1228,142 @@ asynStatus asynMotorController::setIdlePollPeriod(double idlePollPeriod)
   return asynSuccess;
 }
 
+/** Set the maximum moving poll period (in secs) at runtime.
+  * A non-zero value enables adaptive polling, where each axis is polled at a period between 
+  * movingPollPeriod_ and maxMovingPollPeriod depending on how close it is to the end of its move.
+  * See adaptivePollPeriod().  0 disables adaptive polling.
+  * This requires the base class poller thread, so it is an error on controllers that have not
+  * started it with asynMotorController::startPoller(). */
+asynStatus asynMotorController::setMaxMovingPollPeriod(double maxMovingPollPeriod)
+{
+  static const char *functionName = "setMaxMovingPollPeriod";
+
+  if (!pollerStarted_) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: Error port %s does not use the asynMotorController poller\n", 
+      driverName, functionName, portName);
+    return asynError;
+  }
+  asynPrint(pasynUserSelf, ASYN_TRACE_FLOW,
+    "%s:%s: Setting maximum moving poll period to %f\n", 
+    driverName, functionName, maxMovingPollPeriod);
+
+  lock();
+  maxMovingPollPeriod_ = maxMovingPollPeriod;
+  wakeupPoller();
+  unlock();
+  return asynSuccess;
+}
+
+/** Enable or disable coalesced MotorStatus callbacks.
+  * When enabled, asynMotorAxis::callParamCallbacks() does not do the MotorStatus callback to 
+  * devMotorAsyn immediately.  Instead the poller does the callbacks for all axes whose status
+  * changed during a poll cycle in a single batch, after it has released the lock.  This shortens
+  * the time the lock is held and avoids the poller waiting on record processing.
+  * Status changes made outside the poller (e.g. when a move is started) wake up the poller to deliver them.
+  * \param[in] enable 1 to enable coalesced callbacks, 0 to do them immediately.
+  * Enabling this is an error on controllers that have not started the base class poller thread
+  * with asynMotorController::startPoller(), because nothing would ever deliver the callbacks. */
+asynStatus asynMotorController::setCoalescedStatusCallbacks(int enable)
+{
+  static const char *functionName = "setCoalescedStatusCallbacks";
+
+  if (enable && !pollerStarted_) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: Error port %s does not use the asynMotorController poller\n", 
+      driverName, functionName, portName);
+    return asynError;
+  }
+  asynPrint(pasynUserSelf, ASYN_TRACE_FLOW,
+    "%s:%s: Setting coalesced status callbacks to %d\n", 
+    driverName, functionName, enable);
+
+  lock();
+  coalesceStatusCallbacks_ = enable;
+  wakeupPoller();
+  unlock();
+  return asynSuccess;
+}
+
+/** Set the moving and idle poll periods (in secs) of a poll group.
+  * Axes are assigned to poll groups with setAxisPollGroup().  Each axis is then polled at the rates of its
+  * own group, so a move on one axis does not cause axes in other groups to be polled at the moving rate.
+  * Group 0 is the default group for all axes, and uses the controller's movingPollPeriod_ and idlePollPeriod_.
+  * \param[in] group The poll group number, 1 to MAX_POLL_GROUPS-1.
+  * \param[in] movingPollPeriod The time between polls when an axis in the group is moving.
+  * \param[in] idlePollPeriod The time between polls when an axis in the group is not moving. 0 means
+  *                           only poll when woken up by wakeupPoller().
+  * Like setMaxMovingPollPeriod() this requires the base class poller thread. */
+asynStatus asynMotorController::setPollGroupPeriods(int group, double movingPollPeriod, double idlePollPeriod)
+{
+  static const char *functionName = "setPollGroupPeriods";
+
+  if (!pollerStarted_) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: Error port %s does not use the asynMotorController poller\n", 
+      driverName, functionName, portName);
+    return asynError;
+  }
+  if ((group <= 0) || (group >= MAX_POLL_GROUPS)) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: Error poll group %d must be in the range 1 to %d\n", 
+      driverName, functionName, group, MAX_POLL_GROUPS-1);
+    return asynError;
+  }
+  if (movingPollPeriod <= 0.) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: Error moving poll period must be positive, group=%d\n", 
+      driverName, functionName, group);
+    return asynError;
+  }
+  asynPrint(pasynUserSelf, ASYN_TRACE_FLOW,
+    "%s:%s: Setting poll group %d moving poll period to %f, idle poll period to %f\n", 
+    driverName, functionName, group, movingPollPeriod, idlePollPeriod);
+
+  lock();
+  pollGroupMovingPeriod_[group] = movingPollPeriod;
+  pollGroupIdlePeriod_[group] = idlePollPeriod;
+  if (group >= numPollGroups_) numPollGroups_ = group + 1;
+  wakeupPoller();
+  unlock();
+  return asynSuccess;
+}
+
+/** Assign an axis to a poll group.  See setPollGroupPeriods().
+  * \param[in] axis The axis number.
+  * \param[in] group The poll group number, 0 to MAX_POLL_GROUPS-1. */
+asynStatus asynMotorController::setAxisPollGroup(int axis, int group)
+{
+  asynMotorAxis *pAxis;
+  static const char *functionName = "setAxisPollGroup";
+
+  if (!pollerStarted_) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: Error port %s does not use the asynMotorController poller\n", 
+      driverName, functionName, portName);
+    return asynError;
+  }
+  pAxis = getAxis(axis);
+  if (!pAxis) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: Error axis %d not found\n", 
+      driverName, functionName, axis);
+    return asynError;
+  }
+  if ((group < 0) || (group >= MAX_POLL_GROUPS)) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+      "%s:%s: Error poll group %d must be in the range 0 to %d\n", 
+      driverName, functionName, group, MAX_POLL_GROUPS-1);
+    return asynError;
+  }
+
+  lock();
+  pAxis->pollGroup_ = group;
+  wakeupPoller();
+  unlock();
+  return asynSuccess;
+}
+
 /** The following functions have C linkage, and can be called directly or from iocsh */
 
 extern "C" {
@@ -941,6 +1398,66 @@ asynStatus setIdlePollPeriod(const char *portName, double idlePollPeriod)
 
 
 
+asynStatus setMaxMovingPollPeriod(const char *portName, double maxMovingPollPeriod)
+{
+  asynMotorController *pC;
+  static const char *functionName = "setMaxMovingPollPeriod";
+
+  pC = (asynMotorController*) findAsynPortDriver(portName);
+  if (!pC) {
+    printf("%s:%s: Error port %s not found\n", driverName, functionName, portName);
+    return asynError;
+  }
+    
+  return pC->setMaxMovingPollPeriod(maxMovingPollPeriod);
+}
+
+
+
+asynStatus setCoalescedStatusCallbacks(const char *portName, int enable)
+{
+  asynMotorController *pC;
+  static const char *functionName = "setCoalescedStatusCallbacks";
+
+  pC = (asynMotorController*) findAsynPortDriver(portName);
+  if (!pC) {
+    printf("%s:%s: Error port %s not found\n", driverName, functionName, portName);
+    return asynError;
+  }
+    
+  return pC->setCoalescedStatusCallbacks(enable);
+}
+
+asynStatus setPollGroupPeriods(const char *portName, int group, double movingPollPeriod, double idlePollPeriod)
+{
+  asynMotorController *pC;
+  static const char *functionName = "setPollGroupPeriods";
+
+  pC = (asynMotorController*) findAsynPortDriver(portName);
+  if (!pC) {
+    printf("%s:%s: Error port %s not found\n", driverName, functionName, portName);
+    return asynError;
+  }
+    
+  return pC->setPollGroupPeriods(group, movingPollPeriod, idlePollPeriod);
+}
+
+asynStatus setAxisPollGroup(const char *portName, int axis, int group)
+{
+  asynMotorController *pC;
+  static const char *functionName = "setAxisPollGroup";
+
+  pC = (asynMotorController*) findAsynPortDriver(portName);
+  if (!pC) {
+    printf("%s:%s: Error port %s not found\n", driverName, functionName, portName);
+    return asynError;
+  }
+    
+  return pC->setAxisPollGroup(axis, group);
+}
+
+
+
 asynStatus asynMotorEnableMoveToHome(const char *portName, int axis, int distance)
 {
   asynMotorController *pC = NULL;
@@ -993,6 +1510,60 @@ static void setIdlePollPeriodCallFunc(const iocshArgBuf *args)
   setIdlePollPeriod(args[0].sval, args[1].dval);
 }
 
+/* setMaxMovingPollPeriod */
+static const iocshArg setMaxMovingPollPeriodArg0 = {"Controller port name", iocshArgString};
+static const iocshArg setMaxMovingPollPeriodArg1 = {"Max moving poll period", iocshArgDouble};
+static const iocshArg * const setMaxMovingPollPeriodArgs[] = {&setMaxMovingPollPeriodArg0,
+                                                              &setMaxMovingPollPeriodArg1};
+static const iocshFuncDef setMaxMovingPollPeriodDef = {"setMaxMovingPollPeriod", 2, setMaxMovingPollPeriodArgs};
+
+static void setMaxMovingPollPeriodCallFunc(const iocshArgBuf *args)
+{
+  setMaxMovingPollPeriod(args[0].sval, args[1].dval);
+}
+
+/* setCoalescedStatusCallbacks */
+static const iocshArg setCoalescedStatusCallbacksArg0 = {"Controller port name", iocshArgString};
+static const iocshArg setCoalescedStatusCallbacksArg1 = {"Enable", iocshArgInt};
+static const iocshArg * const setCoalescedStatusCallbacksArgs[] = {&setCoalescedStatusCallbacksArg0,
+                                                                   &setCoalescedStatusCallbacksArg1};
+static const iocshFuncDef setCoalescedStatusCallbacksDef = {"setCoalescedStatusCallbacks", 2, setCoalescedStatusCallbacksArgs};
+
+static void setCoalescedStatusCallbacksCallFunc(const iocshArgBuf *args)
+{
+  setCoalescedStatusCallbacks(args[0].sval, args[1].ival);
+}
+
+/* setPollGroupPeriods */
+static const iocshArg setPollGroupPeriodsArg0 = {"Controller port name", iocshArgString};
+static const iocshArg setPollGroupPeriodsArg1 = {"Poll group", iocshArgInt};
+static const iocshArg setPollGroupPeriodsArg2 = {"Moving poll period", iocshArgDouble};
+static const iocshArg setPollGroupPeriodsArg3 = {"Idle poll period", iocshArgDouble};
+static const iocshArg * const setPollGroupPeriodsArgs[] = {&setPollGroupPeriodsArg0,
+                                                           &setPollGroupPeriodsArg1,
+                                                           &setPollGroupPeriodsArg2,
+                                                           &setPollGroupPeriodsArg3};
+static const iocshFuncDef setPollGroupPeriodsDef = {"setPollGroupPeriods", 4, setPollGroupPeriodsArgs};
+
+static void setPollGroupPeriodsCallFunc(const iocshArgBuf *args)
+{
+  setPollGroupPeriods(args[0].sval, args[1].ival, args[2].dval, args[3].dval);
+}
+
+/* setAxisPollGroup */
+static const iocshArg setAxisPollGroupArg0 = {"Controller port name", iocshArgString};
+static const iocshArg setAxisPollGroupArg1 = {"Axis number", iocshArgInt};
+static const iocshArg setAxisPollGroupArg2 = {"Poll group", iocshArgInt};
+static const iocshArg * const setAxisPollGroupArgs[] = {&setAxisPollGroupArg0,
+                                                        &setAxisPollGroupArg1,
+                                                        &setAxisPollGroupArg2};
+static const iocshFuncDef setAxisPollGroupDef = {"setAxisPollGroup", 3, setAxisPollGroupArgs};
+
+static void setAxisPollGroupCallFunc(const iocshArgBuf *args)
+{
+  setAxisPollGroup(args[0].sval, args[1].ival, args[2].ival);
+}
+
 
 /* asynMotorEnableMoveToHome */
 static const iocshArg asynMotorEnableMoveToHomeArg0 = {"Controller port name", iocshArgString};
@@ -1013,6 +1584,10 @@ static void asynMotorControllerRegister(void)
 {
   iocshRegister(&setMovingPollPeriodDef, setMovingPollPeriodCallFunc);
   iocshRegister(&setIdlePollPeriodDef, setIdlePollPeriodCallFunc);
+  iocshRegister(&setMaxMovingPollPeriodDef, setMaxMovingPollPeriodCallFunc);
+  iocshRegister(&setCoalescedStatusCallbacksDef, setCoalescedStatusCallbacksCallFunc);
+  iocshRegister(&setPollGroupPeriodsDef, setPollGroupPeriodsCallFunc);
+  iocshRegister(&setAxisPollGroupDef, setAxisPollGroupCallFunc);
   iocshRegister(&enableMoveToHome, enableMoveToHomeCallFunc);
 }
 epicsExportRegistrar(asynMotorControllerRegister);
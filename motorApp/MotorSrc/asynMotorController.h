@@ -9,10 +9,22 @@
 #define asynMotorController_H
 
 #include <epicsEvent.h>
+#include <epicsMessageQueue.h>
 #include <epicsTypes.h>
 
 #define MAX_CONTROLLER_STRING_SIZE 256
 #define DEFAULT_CONTROLLER_TIMEOUT 2.0
+/* With adaptive polling a moving axis is next polled after this fraction of its predicted time to complete */
+#define ADAPTIVE_POLL_FRACTION 0.25
+/* Next poll time of an idle axis when the idle poll period is 0 */
+#define ADAPTIVE_POLL_NEVER 1.e30
+/* Maximum number of poll groups per controller, including the default group 0 */
+#define MAX_POLL_GROUPS 8
+
+/** Maximum number of profile build/execute/readback requests waiting for the profile thread */
+#define MAX_PROFILE_JOBS 8
+/** Job posted by shutdown() to wake up the profile thread; not a parameter index */
+#define PROFILE_JOB_WAKEUP -1
 
 /** Strings defining parameters for the driver. 
   * These are the values passed to drvUserCreate. 
@@ -176,6 +188,7 @@ class epicsShareClass asynMotorController : public asynPortDriver {
   virtual asynStatus startPoller(double movingPollPeriod, double idlePollPeriod, int forcedFastPolls);
   virtual asynStatus wakeupPoller();
   virtual asynStatus poll();
+  virtual asynStatus pollAll(asynMotorAxis **pAxes, int numAxes, bool *moving);
   virtual asynStatus setDeferredMoves(bool defer);
   void asynMotorPoller();  // This should be private but is called from C function
   
@@ -189,9 +202,19 @@ class epicsShareClass asynMotorController : public asynPortDriver {
   virtual asynStatus executeProfile();
   virtual asynStatus abortProfile();
   virtual asynStatus readbackProfile();
+  void asynMotorProfileJobs();  // This should be private but is called from C function
+  virtual bool profileHooksUnlocked();
+  virtual void shutdown();
   
   virtual asynStatus setMovingPollPeriod(double movingPollPeriod);
   virtual asynStatus setIdlePollPeriod(double idlePollPeriod);
+  virtual asynStatus setMaxMovingPollPeriod(double maxMovingPollPeriod);
+  virtual double adaptivePollPeriod(asynMotorAxis *pAxis, bool moving);
+  virtual asynStatus setCoalescedStatusCallbacks(int enable);
+  virtual asynStatus setPollGroupPeriods(int group, double movingPollPeriod, double idlePollPeriod);
+  virtual asynStatus setAxisPollGroup(int axis, int group);
+  double getPollGroupMovingPeriod(int group);
+  double getPollGroupIdlePeriod(int group);
 
   int shuttingDown_;   /**< Flag indicating that IOC is shutting down.  Stops poller */
 
@@ -292,9 +315,23 @@ class epicsShareClass asynMotorController : public asynPortDriver {
   double idlePollPeriod_;       /**< The time between polls when no axes are moving */
   double movingPollPeriod_;     /**< The time between polls when any axis is moving */
   int    forcedFastPolls_;      /**< The number of forced fast polls when the poller wakes up */
+  bool   pollerStarted_;        /**< Flag that startPoller() has started the base class poller thread */
+  double maxMovingPollPeriod_;  /**< The longest time between polls of a moving axis with adaptive polling, 0=disabled */
+  bool   *pollMoving_;          /**< Per-axis moving flags returned by pollAll() */
+  asynMotorAxis **pollAxes_;    /**< The axes to be polled in this poll cycle */
+  bool   *pollAxesMoving_;      /**< Moving flags for pollAxes_ */
+  int coalesceStatusCallbacks_;  /**< Flag to defer MotorStatus callbacks to the end of the poll cycle */
+  int pollCycleActive_;          /**< Flag that the poller is in a poll cycle */
+  MotorStatus *pendingStatus_;   /**< Deferred MotorStatus callbacks collected at the end of a poll cycle */
+  int *pendingStatusAxes_;       /**< Axis numbers for pendingStatus_ */
+  int numPollGroups_;           /**< One more than the highest poll group defined with setPollGroupPeriods() */
+  double pollGroupMovingPeriod_[MAX_POLL_GROUPS]; /**< Moving poll period of each poll group */
+  double pollGroupIdlePeriod_[MAX_POLL_GROUPS];   /**< Idle poll period of each poll group */
  
   size_t maxProfilePoints_;     /**< Maximum number of profile points */
   double *profileTimes_;        /**< Array of times per profile point */
+  epicsMessageQueueId profileJobQueue_; /**< Build/execute/readback requests for the profile thread */
+  asynStatus queueProfileJob(int function);
 
   int moveToHomeAxis_;
 
@@ -72,6 +72,9 @@
                 } \
             } while (0);
 
+/* Number of words in the mask of changed parameters passed up by intCallback */
+#define CHANGED_MASK_WORDS ((MOTOR_AXIS_NUM_PARAMS + NMASKBITS - 1) / NMASKBITS)
+
 /* Note, these values must not be used for pasynUser->reason in device support  */
 typedef enum {
     /* Parameters - these must match the definitions in motor_interface.h */
@@ -838,12 +841,20 @@ static void intCallback(void *axisPvt, unsigned int nChanged,
     double dvalue;
     unsigned int i, bit_num;
     epicsInt32 changedmask = 0;
+    int changedReasons[CHANGED_MASK_WORDS];
+    int changedOther = 0;
 
     /* We are called back with an array of things that have changed.
-       First put these into a single int32 word for passing up to higher layers
-       Note that for now this relies on the order of the changed flags being
-       correct */
+       First put these into a single int32 word for passing up to higher layers.
+       Also mark them in a mask indexed by parameter, so that each interrupt
+       client below is checked in constant time rather than against the whole list. */
+    memset(changedReasons, 0, sizeof(changedReasons));
     for (i = 0; i < nChanged; i++) {
+        if (changed[i] < (unsigned int)MOTOR_AXIS_NUM_PARAMS) {
+            BIT_SET(changed[i], changedReasons, 1);
+        } else {
+            changedOther = 1;
+        }
         if (changed[i] >= motorAxisDirection && 
             changed[i] <= motorAxisHomed) {
             bit_num = changed[i] - motorAxisDirection;
@@ -873,12 +884,21 @@ static void intCallback(void *axisPvt, unsigned int nChanged,
         addr = pfloat64Interrupt->addr;
         reason = pfloat64Interrupt->pasynUser->reason;
         if (addr == pAxis->num) {
-            for (i = 0; i < nChanged; i++) {
-                if (changed[i] == reason) {
-                    (*pPvt->drvset->getDouble)(pAxis->axis, changed[i], &dvalue);
-                    pfloat64Interrupt->callback(pfloat64Interrupt->userPvt, 
-                                pfloat64Interrupt->pasynUser,
-                                dvalue);
+            if (BIT_ISSET(reason, CHANGED_MASK_WORDS, changedReasons)) {
+                (*pPvt->drvset->getDouble)(pAxis->axis, reason, &dvalue);
+                pfloat64Interrupt->callback(pfloat64Interrupt->userPvt, 
+                            pfloat64Interrupt->pasynUser,
+                            dvalue);
+            }
+            /* Driver specific parameters beyond the mask are matched against the list */
+            else if (changedOther && reason >= (unsigned int)MOTOR_AXIS_NUM_PARAMS) {
+                for (i = 0; i < nChanged; i++) {
+                    if (changed[i] == reason) {
+                        (*pPvt->drvset->getDouble)(pAxis->axis, changed[i], &dvalue);
+                        pfloat64Interrupt->callback(pfloat64Interrupt->userPvt, 
+                                    pfloat64Interrupt->pasynUser,
+                                    dvalue);
+                    }
                 }
             }
         }
@@ -24,13 +24,20 @@ USAGE...        Motor Record Utility Support.
 *                  - Added redundant initialization error check. 
 * .02 03-11-08 rls - 64 bit compatability.
 *                  - add printChIDlist() to iocsh.
+* .03 10-16-26     - Replace the Channel Access client with database event
+*                    subscriptions and database puts; keep a running count of
+*                    moving motors instead of rescanning motorArray on every
+*                    DMOV change.
 */
 
 #include <stdio.h>
 #include <string.h>
-#include <cadef.h>
 #include <dbDefs.h>
+#include <epicsTypes.h>
+#include <dbAccess.h>
+#include <dbEvent.h>
 #include <epicsString.h>
+#include <epicsThread.h>
 #include <cantProceed.h>
 #include <iocsh.h>
 #include <epicsExport.h>
@@ -38,32 +45,30 @@ USAGE...        Motor Record Utility Support.
 
 #include <motor.h>
 
-#define TIMEOUT 60 /* seconds */
-
 /* ----- External Declarations ----- */
 extern char **getMotorList();
 /* ----- --------------------- ----- */
 
 /* ----- Function Declarations ----- */
 RTN_STATUS motorUtilInit(char *);
-static int motorUtil_task(void *);
-static chid getChID(char *);
-static long pvMonitor(int, chid, int);
-static void dmov_handler(struct event_handler_args);
-static void allstop_handler(struct event_handler_args);
-static void stopAll(chid, char *);
-static int motorMovingCount();
-static void moving(int, chid, short);
+static int motorUtilSetup();
+static int getAddr(char *, DBADDR *);
+static dbEventSubscription pvMonitor(int, DBADDR *, int);
+static void dmov_handler(void *, DBADDR *, int, struct db_field_log *);
+static void allstop_handler(void *, DBADDR *, int, struct db_field_log *);
+static void stopAll(DBADDR *, char *);
+static void moving(int, short);
 /* ----- --------------------- ----- */
 
 
 typedef struct motor_pv_info
 {
     char name[PVNAME_SZ];      /* pv names limited to 60 chars + term. in dbDefs.h */
-    chid chid_dmov;     /* Channel id for <motor name>.DMOV */
-    chid chid_stop;     /* Channel id for <motor name>.STOP */
+    DBADDR addr_dmov;   /* Address of <motor name>.DMOV */
+    DBADDR addr_stop;   /* Address of <motor name>.STOP */
+    dbEventSubscription sub_dmov;
     int in_motion;
-    int index;          /* Call to ca_add_event() must have ptr to argument. */
+    int index;          /* Call to db_add_event() must have ptr to argument. */
 } Motor_pv_info;
 
 
@@ -76,9 +81,14 @@ int numMotors = 0;
 static Motor_pv_info *motorArray;
 static char **motorlist = 0;
 static char *vme;
+static dbEventCtx eventCtx;
+/* All event callbacks run on the one event task of eventCtx, so the count of
+ * moving motors is maintained there without further locking. */
+static int numMotorsMoving = 0;
 static int old_numMotorsMoving = 0;
 static short old_alldone_value = 1;
-static chid chid_allstop, chid_moving, chid_alldone, chid_movingdiff;
+static DBADDR addr_allstop, addr_moving, addr_alldone, addr_movingdiff;
+static dbEventSubscription sub_allstop;
 /* ----- ---------------- ----- */
 
 
@@ -103,21 +113,16 @@ RTN_STATUS motorUtilInit(char *vme_name)
     initialized = true;
     vme = epicsStrDup(vme_name);
 
-    epicsThreadCreate((char *) "motorUtil", epicsThreadPriorityMedium,
-                      epicsThreadGetStackSize(epicsThreadStackMedium),
-                      (EPICSTHREADFUNC) motorUtil_task, (void *) NULL);
+    if (motorUtilSetup() != OK)
+        status = ERROR;
     return(status);
 }
 
 
-static int motorUtil_task(void *arg)
+static int motorUtilSetup()
 {
     char temp[PVNAME_STRINGSZ+5];
-    int itera, status;
-    epicsEventId wait_forever;
-
-    SEVCHK(ca_context_create(ca_enable_preemptive_callback),
-           "motorUtil: ca_context_create() error");
+    int itera;
 
     motorlist = getMotorList();
     if (motorUtil_debug)
@@ -131,144 +136,136 @@ static int motorUtil_task(void *arg)
         /* setup $(P)moving */
         strcpy(temp, vme);
         strcat(temp, "moving.VAL");
-        chid_moving = getChID(temp);
+        itera = getAddr(temp, &addr_moving);
 
         /* setup $(P)alldone */
         strcpy(temp, vme);
         strcat(temp, "alldone.VAL");
-        chid_alldone = getChID(temp);
+        itera |= getAddr(temp, &addr_alldone);
 
         /* setup $(P)movingDiff */
         strcpy(temp, vme);
         strcat(temp, "movingDiff.VAL");
-        chid_movingdiff = getChID(temp);
+        itera |= getAddr(temp, &addr_movingdiff);
 
-	if (!chid_moving || !chid_alldone || !chid_movingdiff) {
-	    errlogPrintf("Failed to connect to %smoving or %salldone or %smovingDiff.\n"
+	if (itera != 0) {
+	    errlogPrintf("Failed to find %smoving or %salldone or %smovingDiff.\n"
 			 "Check prefix matches Db\n", vme, vme, vme);
-	    ca_task_exit();
 	    return ERROR;
 	}
 
+        eventCtx = db_init_events();
+        if (!eventCtx || db_start_events(eventCtx, "motorUtil", NULL, NULL,
+                                         epicsThreadPriorityMedium) != DB_EVENT_OK)
+        {
+            errlogPrintf("motorUtil: unable to start the event task\n");
+            return ERROR;
+        }
+
         /* loop over motors in motorlist and fill in motorArray */
         for (itera=0; itera < numMotors; itera++)
         {
             motorArray[itera].index = itera;
 
-            /* Setup .DMOVs */
-            strcpy(motorArray[itera].name, motorlist[itera]);
-            strcpy(temp, motorlist[itera]);
-            strcat(temp, ".DMOV");
-            motorArray[itera].chid_dmov = getChID(temp);
-            status = pvMonitor(1, motorArray[itera].chid_dmov, itera);
-                    
             /* Setup .STOPs */
+            strcpy(motorArray[itera].name, motorlist[itera]);
             strcpy(temp, motorlist[itera]);
             strcat(temp, ".STOP");
-            motorArray[itera].chid_stop = getChID(temp);        
+            getAddr(temp, &motorArray[itera].addr_stop);
+
+            /* Setup .DMOVs */
+            strcpy(temp, motorlist[itera]);
+            strcat(temp, ".DMOV");
+            if (getAddr(temp, &motorArray[itera].addr_dmov) == 0)
+                motorArray[itera].sub_dmov = pvMonitor(1, &motorArray[itera].addr_dmov, itera);
         }
 
         /* setup $(P)allstop */
         strcpy(temp, vme);
         strcat(temp, "allstop.VAL");
-        chid_allstop = getChID(temp);
-	if (!chid_allstop) {
-	    errlogPrintf("Failed to connect to %sallstop\n",vme);
+	if (getAddr(temp, &addr_allstop) != 0) {
+	    errlogPrintf("Failed to find %sallstop\n",vme);
 	} else {
-	    status = pvMonitor(0, chid_allstop, -1);
+	    sub_allstop = pvMonitor(0, &addr_allstop, -1);
 	}
     }
-    
-    /* Wait on a (never signalled) event here, rather than suspending the
-       thread, so as not to show up in the thread list as "SUSPENDED", which
-       is usually a sign of a fault. */
-    wait_forever = epicsEventCreate(epicsEventEmpty);
-    if (wait_forever) {
-	epicsEventMustWait(wait_forever);
-    }
-    return(ERROR);
+    return(OK);
 }
 
 
-static chid getChID(char *PVname)
+static int getAddr(char *PVname, DBADDR *paddr)
 {
-    chid channelID = 0;
-    int status;
+    long status;
 
     if (motorUtil_debug)
-	errlogPrintf("getChID(%s)\n", PVname);
+	errlogPrintf("getAddr(%s)\n", PVname);
 
-    /* In R3.14 ca_create_channel() will replace ca_search_and_connect() */
-    status = ca_search_and_connect(PVname, &channelID, 0, 0);
-    if (status == ECA_NORMAL) 
+    status = dbNameToAddr(PVname, paddr);
+    if (status)
     {
-	status = ca_pend_io(TIMEOUT);
+        errlogPrintf("motorUtil.cc: getAddr(%s) error: %li\n", PVname, status);
+        return -1;
     }
-
-    if (status != ECA_NORMAL)
-    {
-        SEVCHK(status, "ca_search_and_connect");
-        errlogPrintf("motorUtil.cc: getChID(%s) error: %i\n", PVname, status);
-	channelID = 0;
-    }
-    return channelID;
+    return 0;
 }
 
 
-static long pvMonitor(int eventType, chid channelID, int motor_index)
+static dbEventSubscription pvMonitor(int eventType, DBADDR *paddr, int motor_index)
 {
-    int status; 
+    dbEventSubscription sub;
 
     /* Create monitor */
     if (eventType)      /* moving() */
-        status = ca_add_event(DBR_SHORT, channelID, &dmov_handler,
-                              &(motorArray[motor_index].index), 0);
+        sub = db_add_event(eventCtx, paddr, dmov_handler,
+                           &(motorArray[motor_index].index), DBE_VALUE);
     else                /* stopAll() */
-        status = ca_add_event(DBR_STRING, channelID, &allstop_handler, 0, 0);
-    status = ca_pend_io(TIMEOUT);
+        sub = db_add_event(eventCtx, paddr, allstop_handler, NULL, DBE_VALUE);
 
-    if (status != ECA_NORMAL)
+    if (sub == NULL)
     {
-        SEVCHK(status, "ca_add_event");
-        ca_task_exit(); /* this is serious */
-        return status;
+        errlogPrintf("motorUtil.cc: db_add_event(%s) failed\n", paddr->precord->name);
+        return NULL;
     }
 
-    return ECA_NORMAL;
+    /* Like a CA monitor, deliver the current value first */
+    db_event_enable(sub);
+    db_post_single_event(sub);
+    return sub;
 }
 
 
-static void allstop_handler(struct event_handler_args args)
+static void allstop_handler(void *usr, DBADDR *paddr, int eventsRemaining, struct db_field_log *pfl)
 {
-    stopAll(args.chid, (char *) args.dbr);
+    char value[MAX_STRING_SIZE];
+
+    if (dbGetField(paddr, DBR_STRING, value, NULL, NULL, pfl) == 0)
+        stopAll(paddr, value);
 }
 
 
-static void stopAll(chid callback_chid, char *callback_value)
+static void stopAll(DBADDR *paddr, char *callback_value)
 {
-    int itera, status = 0;
+    int itera;
     short val = 1, release_val = 0;
     
-    if (callback_chid != chid_allstop)
-        errlogPrintf("callback_chid = %p, chid_allstop = %p\n", callback_chid,
-                      chid_allstop);
+    if (paddr != &addr_allstop)
+        errlogPrintf("callback addr = %p, addr_allstop = %p\n", paddr,
+                      &addr_allstop);
     
     if (strcmp(callback_value, "release") != 0)
     {
         /* if at least one motor is moving, then continue with stop all */
-        if (motorMovingCount())
+        if (numMotorsMoving)
         {
             for(itera=0; itera < numMotors; itera++)
 	        /* Only stop a motor that is moving.  This should avoid problems caused by trying
 		to stop motor records for which device and driver support have not been loaded.*/
-                if (motorArray[itera].in_motion == 1)
-		    ca_put(DBR_SHORT, motorArray[itera].chid_stop, &val);
-            status = ca_flush_io(); 
+                if (motorArray[itera].in_motion == 1 && motorArray[itera].addr_stop.precord)
+		    dbPutField(&motorArray[itera].addr_stop, DBR_SHORT, &val, 1);
         }
 
         /* reset allstop so that it may be called again */
-        ca_put(DBR_SHORT, chid_allstop, &release_val);
-        status = ca_flush_io();
+        dbPutField(&addr_allstop, DBR_SHORT, &release_val, 1);
         if (motorUtil_debug)
             errlogPrintf("reset allstop to \"release\"\n");
     }
@@ -277,17 +274,19 @@ static void stopAll(chid callback_chid, char *callback_value)
 }
 
 
-static void dmov_handler(struct event_handler_args args)
+static void dmov_handler(void *usr, DBADDR *paddr, int eventsRemaining, struct db_field_log *pfl)
 {
-    moving(*((int *) args.usr), args.chid, *((short *) args.dbr));
+    short dmov;
+
+    if (dbGetField(paddr, DBR_SHORT, &dmov, NULL, NULL, pfl) == 0)
+        moving(*((int *) usr), dmov);
 }
 
 
-static void moving(int callback_motor_index, chid callback_chid,
-                   short callback_dmov)
+static void moving(int callback_motor_index, short callback_dmov)
 {
     short new_alldone_value, done = 1, not_done = 0;
-    int numMotorsMoving, status;
+    int in_motion = (callback_dmov) ? 0 : 1;
     char diffChar;
     char diffStr[PVNAME_STRINGSZ+1];
 
@@ -295,18 +294,14 @@ static void moving(int callback_motor_index, chid callback_chid,
         errlogPrintf("%s is %s\n", motorArray[callback_motor_index].name,
                (callback_dmov) ? "STOPPED" : "MOVING");
 
-    if (callback_dmov)
-    {                      
-        motorArray[callback_motor_index].in_motion = 0;
-        diffChar = '-';
-    }
-    else
+    diffChar = (callback_dmov) ? '-' : '+';
+
+    /* update the count of moving motors on transitions only */
+    if (motorArray[callback_motor_index].in_motion != in_motion)
     {
-        motorArray[callback_motor_index].in_motion = 1;
-        diffChar = '+';
+        motorArray[callback_motor_index].in_motion = in_motion;
+        numMotorsMoving += (in_motion) ? 1 : -1;
     }
-    
-    numMotorsMoving = motorMovingCount();
 
     new_alldone_value = (numMotorsMoving) ? 0 : 1;
     
@@ -319,7 +314,7 @@ static void moving(int callback_motor_index, chid callback_chid,
             if (motorUtil_debug)
                 errlogPrintf("sending alldone = TRUE\n");
 
-            ca_put(DBR_SHORT, chid_alldone, &done);
+            dbPutField(&addr_alldone, DBR_SHORT, &done, 1);
             old_alldone_value = new_alldone_value;
         }
         else
@@ -327,7 +322,7 @@ static void moving(int callback_motor_index, chid callback_chid,
             if (motorUtil_debug)
                 errlogPrintf("sending alldone = FALSE\n");
 
-            ca_put(DBR_SHORT, chid_alldone, &not_done);
+            dbPutField(&addr_alldone, DBR_SHORT, &not_done, 1);
             old_alldone_value = new_alldone_value;
         }
     }
@@ -337,34 +332,22 @@ static void moving(int callback_motor_index, chid callback_chid,
     /* check to see if $(P)moving needs to be updated */
     if (numMotorsMoving != old_numMotorsMoving)
     {
+        epicsInt32 count = numMotorsMoving;
+
         if (motorUtil_debug)
             errlogPrintf("updating number of motors moving\n");
 
         /* give $(P)moving the appropriate value */
-        ca_put(DBR_LONG, chid_moving, &numMotorsMoving);
+        dbPutField(&addr_moving, DBR_LONG, &count, 1);
 	
 	/* Tell which motor's dmov changed */
 	sprintf(diffStr, "%c%s", diffChar, motorArray[callback_motor_index].name);
-	ca_array_put(DBR_CHAR, strlen(diffStr)+1, chid_movingdiff, diffStr); 
+	dbPutField(&addr_movingdiff, DBR_CHAR, diffStr, strlen(diffStr)+1); 
 
         old_numMotorsMoving = numMotorsMoving;
     }
     else if (motorUtil_debug)
 	errlogPrintf("the number of motors moving remains the same.\n");
-    
-    /* send the ca_puts */
-    status = ca_flush_io();
-}
-
-
-static int motorMovingCount()
-{
-    int itera, in_motion_count=0;
-
-    for (itera=0; itera < numMotors; itera++)
-        in_motion_count += motorArray[itera].in_motion;
-
-    return in_motion_count;
 }
 
 
@@ -387,16 +370,13 @@ void printChIDlist()
 
     for (itera=0; itera < numMotors; itera++)
     {
-        errlogPrintf("i = %i,\tname = %s\tchid_dmov = %p\tchid_stop = \
-               %p\tin_motion = %i\tindex = %i\n", itera,
-               motorArray[itera].name, motorArray[itera].chid_dmov,
-               motorArray[itera].chid_stop, motorArray[itera].in_motion,
-               motorArray[itera].index);
+        errlogPrintf("i = %i,\tname = %s\tsub_dmov = %p\tin_motion = %i\tindex = %i\n",
+               itera, motorArray[itera].name, motorArray[itera].sub_dmov,
+               motorArray[itera].in_motion, motorArray[itera].index);
     }
     
-    errlogPrintf("chid_allstop = %p\n", chid_allstop);
-    errlogPrintf("chid_alldone = %p\n", chid_alldone);
-    errlogPrintf("chid_moving = %p\n",  chid_moving);
+    errlogPrintf("sub_allstop = %p\n", sub_allstop);
+    errlogPrintf("moving = %i\n", numMotorsMoving);
 }
 
 
@@ -48,10 +48,18 @@ USAGE...        This file contains driver functions that are common
  *                  messages.
  * .07 11/30/12 rls In process_messages(), pass commanded velocity from
  *                  motor_info->velocity to node->velocity with INFO request.
+ * .08 10/16/26     Optional per-card worker threads (motordrvComCardWorkers).
+ * .09 10/16/26     Preallocate the mess_node free list; drain message queues
+ *                  with one lock per batch instead of one lock per message.
+ * .10 10/16/26     Per-axis "stale data" deadlines; wait until the earliest
+ *                  axis deadline, service only the axes that were deferred
+ *                  and defer INFO requests, with the messages queued after
+ *                  them for the same axis, instead of sleeping inline.
  */
 
 
 #include        <stdlib.h>
+#include        <epicsStdio.h>
 #include        <string.h>
 #include        <callback.h>
 #include        <epicsThread.h>
@@ -78,10 +86,51 @@ static inline void Debug(int level, const char *format, ...) {
   #endif
 }
 
+/* When nonzero, motor_task() starts one worker thread per card; each worker
+ * polls and processes the message queue of its own card only, so that a slow
+ * controller no longer delays the other cards of the same driver.  The
+ * driver's sendmsg(), getmsg(), setstat() and strtstat() functions MUST be
+ * reentrant across cards to use this mode. */
+volatile int motordrvComCardWorkers = 0;
+extern "C" {epicsExportAddress(int, motordrvComCardWorkers);}
+
+/* Per-card worker thread data. */
+struct card_worker
+{
+    struct driver_table *table;
+    int card;
+    struct circ_queue queue;    /* Messages for this card only. */
+    struct circ_queue deferred; /* INFO requests waiting for stale data delay,
+                                   and the messages for their axes after them. */
+    epicsEvent *quelockptr;
+    epicsEvent *semptr;
+    double scan_sec;
+    double stale_data_max_delay;
+};
+
+/* Number of mess_node's preallocated per axis; one held as the axis's
+ * motor_motion, one for its status callback and one for a queued request.
+ * motor_malloc() falls back to malloc() when the pool is exhausted. */
+#define MESS_POOL_NODES_PER_AXIS 3
+
+/* Guards the "any_motor_in_motion" bits shared by all card workers. */
+static epicsEvent inmotion_lock(epicsEventFull);
+
 /* Function declarations. */
-static double query_axis(int, struct driver_table *, epicsTime, double);
-static void process_messages(struct driver_table *, epicsTime, double);
-static struct mess_node *get_head_node(struct driver_table *);
+static void card_task(struct card_worker *);
+static void dispatch_task(struct thread_args *, double, double);
+static double query_axis(int, struct driver_table *, epicsTime, double,
+                         const epicsTime *);
+static double process_messages(struct driver_table *, struct circ_queue *,
+                               epicsEvent *, struct circ_queue *, epicsTime, double);
+static double earliest_delay(double, double);
+static void reject_message(struct mess_node *);
+static void defer_message(struct circ_queue *, struct mess_node *);
+static bool axis_deferred(const struct circ_queue *, int, int);
+static void set_in_motion(struct driver_table *, int, bool);
+static void put_tail_node(struct circ_queue *, epicsEvent *, struct mess_node *);
+static struct mess_node *get_all_nodes(struct circ_queue *, epicsEvent *);
+static void motor_pool_init(struct driver_table *);
 static struct mess_node *motor_malloc(struct circ_queue *, epicsEvent *);
 
 
@@ -89,14 +138,15 @@ static struct mess_node *motor_malloc(struct circ_queue *, epicsEvent *);
  * FUNCION...   motor_task()
  * LOGIC:
  *  WHILE FOREVER
- *      IF no motors in motion for this board type.
- *          Set "wait_time" to WAIT_FOREVER.
- *      ELSE IF stale data timer is active (stale_data_delay != 0).
- *          Set "wait_time" to the remaining stale data time.
+ *      IF stale data timer is active (stale_data_delay != 0).
+ *          Set "wait_time" to the time until the earliest axis deadline.
  *          Clear stale data timer active indicator (stale_data_delay = 0).
+ *          Set deadline pass indicator.
+ *      ELSE IF no motors in motion for this board type.
+ *          Set "wait_time" to WAIT_FOREVER.
  *      ELSE
  *          Update current_time.
- *          Set "time_lapse" to time elapsed (in seconds) since last update.
+ *          Set "time_lapse" to time elapsed (in seconds) since last scan.
  *          IF elapsed time (time_lapse) < user delay (scan_sec).
  *              Set "wait_time" to (user delay - elapsed time).
  *              IF "wait_time" < 1/2 quantum time unit.
@@ -109,36 +159,42 @@ static struct mess_node *motor_malloc(struct circ_queue *, epicsEvent *);
  *      IF wait_time nonzero.
  *          Pend on semaphore with "wait_time" timeout argument.
  *      ENDIF
- *      Update "previous_time".
+ *      Update "previous_time"; IF not a deadline pass, update "scan_time".
  *      IF the "any_motor_in_motion" indicator is true.
  *          IF VME58 instance of this task.
  *              Start data area update on all cards - Call start_status().
  *          ENDIF
  *          FOR each OMS board.
  *              IF motor data structure defined, AND, motor-in-motion indicator true.
- *                  Update OMS board status - call query_axis().
+ *                  Update OMS board status - call query_axis(); on a deadline
+ *                      pass, only axes deferred at "scan_time" are updated.
  *              ENDIF
  *          ENDFOR
  *      ENDIF
  *      Process commands - call process_messages().
+ *      Set stale_data_delay to the earliest pending axis deadline.
  *  ENDWHILE
  *
  * NOTES... This function MUST BE reentrant.
+ *          If motordrvComCardWorkers is nonzero, the above loop is run by one
+ *          card_task() thread per card and this thread only dispatches the
+ *          driver's message queue to them - see dispatch_task().
  */
 /*****************************************************/
 
 epicsShareFunc int motor_task(struct thread_args *args)
 {
     struct driver_table *tabptr;
-    bool sem_ret;
-    epicsTime previous_time, current_time;
+    bool sem_ret, deadline_pass;
+    epicsTime previous_time, current_time, scan_time;
     double scan_sec, wait_time, time_lapse, stale_data_max_delay, stale_data_delay = 0.0;
     const double quantum = epicsThreadSleepQuantum();
     double half_quantum;
+    struct circ_queue deferred = {NULL, NULL};
     int itera;
 
     tabptr = args->table;    
-    previous_time = epicsTime::getCurrent();
+    previous_time = scan_time = epicsTime::getCurrent();
     scan_sec = 1 / (double) args->motor_scan_rate;      /* Convert HZ to seconds. */
 
     if (args->update_delay == 0.0)
@@ -150,19 +206,29 @@ epicsShareFunc int motor_task(struct thread_args *args)
 
     half_quantum = quantum / 2;
 
+    motor_pool_init(tabptr);
+
+    if (motordrvComCardWorkers != 0)
+    {
+        dispatch_task(args, scan_sec, stale_data_max_delay);
+        return(0);
+    }
+
     for(;;)
     {
-        if (*tabptr->any_inmotion_ptr == 0)
-            wait_time = 1000;   /* Wait forever = 1,000 seconds. */
-        else if (stale_data_delay != 0)
+        deadline_pass = false;
+        if (stale_data_delay != 0)
         {
             wait_time = stale_data_delay;
             stale_data_delay = 0;
+            deadline_pass = true;
         }
+        else if (*tabptr->any_inmotion_ptr == 0)
+            wait_time = 1000;   /* Wait forever = 1,000 seconds. */
         else
         {
             current_time = epicsTime::getCurrent();
-            time_lapse = current_time - previous_time;
+            time_lapse = current_time - scan_time;
             if (time_lapse < scan_sec)
             {
                 wait_time = scan_sec - time_lapse;
@@ -178,6 +244,8 @@ epicsShareFunc int motor_task(struct thread_args *args)
         if (wait_time != 0.0)
             sem_ret = tabptr->semptr->wait(wait_time);
         previous_time = epicsTime::getCurrent();
+        if (deadline_pass == false)
+            scan_time = previous_time;
 
         if (*tabptr->any_inmotion_ptr)
         {
@@ -188,17 +256,185 @@ epicsShareFunc int motor_task(struct thread_args *args)
             {
                 struct controller *brdptr = (*tabptr->card_array)[itera];
                 if (brdptr != NULL && brdptr->motor_in_motion)
-                    stale_data_delay = query_axis(itera, tabptr, previous_time, stale_data_max_delay);
+                    stale_data_delay = earliest_delay(stale_data_delay,
+                        query_axis(itera, tabptr, previous_time, stale_data_max_delay,
+                                   deadline_pass ? &scan_time : NULL));
             }
         }
-        process_messages(tabptr, previous_time, stale_data_max_delay);
+        stale_data_delay = earliest_delay(stale_data_delay,
+            process_messages(tabptr, tabptr->queptr, tabptr->quelockptr, &deferred,
+                             previous_time, stale_data_max_delay));
     }
     return(0);
 }
 
 
+/*
+ * FUNCTION... dispatch_task()
+ *
+ * USAGE... Per-card worker mode of motor_task().
+ *
+ * LOGIC...
+ *  Create a card_worker and a card_task() thread for each defined card.
+ *  WHILE FOREVER
+ *      Pend on the driver's semaphore.
+ *      Move each node from the driver's queue to the queue of its card and
+ *          wake up that card's worker; reject nodes for undefined cards.
+ *      IF no node was dispatched (e.g., an interrupt woke this task).
+ *          Wake up all card workers.
+ *      ENDIF
+ *  ENDWHILE
+ */
+
+static void dispatch_task(struct thread_args *args, double scan_sec,
+                          double stale_data_max_delay)
+{
+    struct driver_table *tabptr = args->table;
+    struct card_worker **workers;
+    struct mess_node *node, *next;
+    int numcards = *tabptr->cardcnt_ptr;
+    char name[64];
+    int itera;
+
+    workers = (struct card_worker **) calloc(numcards > 0 ? numcards : 1,
+                                             sizeof(struct card_worker *));
+
+    for (itera = 0; itera < numcards; itera++)
+    {
+        struct card_worker *wrkptr;
+
+        if ((*tabptr->card_array)[itera] == NULL)
+            continue;
+
+        wrkptr = (struct card_worker *) malloc(sizeof(struct card_worker));
+        wrkptr->table = tabptr;
+        wrkptr->card = itera;
+        wrkptr->queue.head = wrkptr->queue.tail = (struct mess_node *) NULL;
+        wrkptr->deferred.head = wrkptr->deferred.tail = (struct mess_node *) NULL;
+        wrkptr->quelockptr = new epicsEvent(epicsEventFull);
+        wrkptr->semptr = new epicsEvent(epicsEventEmpty);
+        wrkptr->scan_sec = scan_sec;
+        wrkptr->stale_data_max_delay = stale_data_max_delay;
+        workers[itera] = wrkptr;
+
+        epicsSnprintf(name, sizeof(name), "%s_%d", epicsThreadGetNameSelf(), itera);
+        epicsThreadCreate(name, epicsThreadGetPrioritySelf(),
+                          epicsThreadGetStackSize(epicsThreadStackMedium),
+                          (EPICSTHREADFUNC) card_task, (void *) wrkptr);
+    }
+
+    for(;;)
+    {
+        bool dispatched = false;
+
+        tabptr->semptr->wait();
+
+        next = get_all_nodes(tabptr->queptr, tabptr->quelockptr);
+        while ((node = next))
+        {
+            int card = node->card;
+
+            next = node->next;
+            if (card >= 0 && card < numcards && workers[card] != NULL)
+            {
+                put_tail_node(&workers[card]->queue, workers[card]->quelockptr, node);
+                workers[card]->semptr->signal();
+                dispatched = true;
+            }
+            else
+                reject_message(node);
+        }
+
+        if (dispatched == false)
+        {
+            for (itera = 0; itera < numcards; itera++)
+                if (workers[itera] != NULL)
+                    workers[itera]->semptr->signal();
+        }
+    }
+}
+
+
+/*
+ * FUNCTION... card_task()
+ *
+ * USAGE... Per-card worker thread; same logic as motor_task() restricted to
+ *          one card and its own message queue.
+ */
+
+static void card_task(struct card_worker *wrkptr)
+{
+    struct driver_table *tabptr = wrkptr->table;
+    struct controller *brdptr = (*tabptr->card_array)[wrkptr->card];
+    epicsTime previous_time, current_time, scan_time;
+    double wait_time, time_lapse, stale_data_delay = 0.0;
+    const double half_quantum = epicsThreadSleepQuantum() / 2;
+    bool deadline_pass;
+
+    previous_time = scan_time = epicsTime::getCurrent();
+
+    for(;;)
+    {
+        deadline_pass = false;
+        if (stale_data_delay != 0)
+        {
+            wait_time = stale_data_delay;
+            stale_data_delay = 0;
+            deadline_pass = true;
+        }
+        else if (brdptr->motor_in_motion == 0)
+            wait_time = 1000;   /* Wait forever = 1,000 seconds. */
+        else
+        {
+            current_time = epicsTime::getCurrent();
+            time_lapse = current_time - scan_time;
+            if (time_lapse < wrkptr->scan_sec)
+            {
+                wait_time = wrkptr->scan_sec - time_lapse;
+                if (wait_time < half_quantum)
+                    wait_time = 0.0;
+            }
+            else
+                wait_time = 0.0;
+        }
+
+        Debug(5, "card_task: card = %d, wait_time = %f\n", wrkptr->card, wait_time);
+
+        if (wait_time != 0.0)
+            wrkptr->semptr->wait(wait_time);
+        previous_time = epicsTime::getCurrent();
+        if (deadline_pass == false)
+            scan_time = previous_time;
+
+        if (brdptr->motor_in_motion)
+        {
+            if (tabptr->strtstat != NULL)
+                (*tabptr->strtstat) (wrkptr->card);
+            stale_data_delay = query_axis(wrkptr->card, tabptr, previous_time,
+                                          wrkptr->stale_data_max_delay,
+                                          deadline_pass ? &scan_time : NULL);
+        }
+        stale_data_delay = earliest_delay(stale_data_delay,
+            process_messages(tabptr, &wrkptr->queue, wrkptr->quelockptr,
+                             &wrkptr->deferred, previous_time,
+                             wrkptr->stale_data_max_delay));
+    }
+}
+
+
+/*
+ * FUNCTION... query_axis()
+ *
+ * USAGE... Update the status of each moving axis on "card" whose stale data
+ *          deadline (status_delay + max_delay) has passed.  If "scan_tick" is
+ *          not NULL, only axes that were not yet due at "scan_tick" are updated;
+ *          the others were already updated by that scan.
+ *
+ * RETURNS... Time until the earliest deadline of a skipped axis, or zero.
+ */
+
 static double query_axis(int card, struct driver_table *tabptr, epicsTime tick,
-                         double max_delay)
+                         double max_delay, const epicsTime *scan_tick)
 {
     struct controller *brdptr;
     double rtndelay = 0.0;
@@ -224,11 +460,10 @@ static double query_axis(int card, struct driver_table *tabptr, epicsTime tick,
                 delay = 0.0;
 
             if (delay < max_delay)
-            {
-                delay = max_delay - delay;
-                if (delay > rtndelay)
-                    rtndelay = delay;
-            }
+                rtndelay = earliest_delay(rtndelay, max_delay - delay);
+            else if (scan_tick != NULL && *scan_tick >= motor_info->status_delay &&
+                     (*scan_tick - motor_info->status_delay) >= max_delay)
+                continue;   /* Already updated at scan_tick. */
             else if ((*tabptr->setstat) (card, index))
             {
                 struct mess_node *mess_ret;
@@ -278,9 +513,7 @@ static double query_axis(int card, struct driver_table *tabptr, epicsTime tick,
                 callbackRequest(&mess_ret->callback);
 
                 if (brdptr->motor_in_motion == 0)
-                {
-                    SET_MM_OFF(*tabptr->any_inmotion_ptr, card);
-                }
+                    set_in_motion(tabptr, card, false);
             }
         }
     }
@@ -289,18 +522,36 @@ static double query_axis(int card, struct driver_table *tabptr, epicsTime tick,
 }
 
 
-static void process_messages(struct driver_table *tabptr, epicsTime tick,
-                             double max_delay)
+/*
+ * FUNCTION... process_messages()
+ *
+ * USAGE... Process the previously deferred INFO requests, then the messages on
+ *          the queue.  An INFO request for an axis whose stale data deadline
+ *          has not passed is moved to the "deferred" list.  So that each
+ *          axis's messages are processed in the order they were sent, the
+ *          messages after it for the same axis are deferred with it.
+ *
+ * RETURNS... Time until the earliest deadline of a deferred request, or zero.
+ */
+
+static double process_messages(struct driver_table *tabptr, struct circ_queue *qptr,
+                               epicsEvent *lockptr, struct circ_queue *deferred,
+                               epicsTime tick, double max_delay)
 {
-    struct mess_node *node, *motor_motion;
-    double delay;
+    struct mess_node *node, *next, *motor_motion;
+    double delay, rtndelay = 0.0;
 
     Debug(5, "process_messages: entry\n");
 
-    while ((node = get_head_node(tabptr)))
+    /* Drain the queue a batch at a time; pick up messages queued meanwhile. */
+    next = deferred->head;
+    deferred->head = deferred->tail = (struct mess_node *) NULL;
+    while (next || (next = get_all_nodes(qptr, lockptr)))
     {
         int card, axis;
 
+        node = next;
+        next = node->next;
         card = node->card;
         axis = node->signal;
 
@@ -318,6 +569,14 @@ static void process_messages(struct driver_table *tabptr, epicsTime tick,
             else
                 axis_name = tabptr->axis_names[axis];
 
+            /* Wait behind a deferred INFO for this axis; processing a later
+             * MOTION now would also restart the INFO's status delay. */
+            if (axis_deferred(deferred, card, axis))
+            {
+                defer_message(deferred, node);
+                continue;
+            }
+
             motor_info = &((*tabptr->card_array)[card]->motor_info[axis]);
             motor_motion = motor_info->motor_motion;
             brdptr = (*tabptr->card_array)[card];
@@ -347,7 +606,7 @@ static void process_messages(struct driver_table *tabptr, epicsTime tick,
                 else
                     motor_free(motor_motion, tabptr);
 
-                SET_MM_ON(*tabptr->any_inmotion_ptr, card);
+                set_in_motion(tabptr, card, true);
                 motor_info->motor_motion = node;
                 motor_info->status_delay = tick;
                 break;
@@ -363,7 +622,7 @@ static void process_messages(struct driver_table *tabptr, epicsTime tick,
                 else
                     motor_free(motor_motion, tabptr);
 
-                SET_MM_ON(*tabptr->any_inmotion_ptr, card);
+                set_in_motion(tabptr, card, true);
                 motor_info->no_motion_count = 0;
                 motor_info->motor_motion = node;
                 motor_info->status_delay = tick;
@@ -376,7 +635,12 @@ static void process_messages(struct driver_table *tabptr, epicsTime tick,
                 if (delay < 0.0)        /* Protect against negative delay. */
                     delay = 0.0;
                 if (delay < max_delay)
-                    epicsThreadSleep(max_delay - delay);
+                {
+                    /* Retry at this axis's deadline; don't stall the task. */
+                    rtndelay = earliest_delay(rtndelay, max_delay - delay);
+                    defer_message(deferred, node);
+                    break;
+                }
 
                 if (tabptr->strtstat != NULL)
                     (*tabptr->strtstat) (card);
@@ -421,42 +685,107 @@ static void process_messages(struct driver_table *tabptr, epicsTime tick,
             }
         }
         else
-        {
-            node->position = 0;
-            node->encoder_position = 0;
-            node->velocity = 0;
-            node->status.All = 0;
-            node->status.Bits.RA_PROBLEM = 1;
-            callbackRequest((CALLBACK *) node);
-        }
+            reject_message(node);
     }
     Debug(5, "process_messages: exit\n");
+    return(rtndelay);
 }
 
 
-/*****************************************************/
-/* Get a message off the queue */
-/* get_head_node()                           */
-/*****************************************************/
-static struct mess_node *get_head_node(struct driver_table *tabptr)
+/* Earliest of two stale data delays; zero indicates no pending deadline. */
+static double earliest_delay(double delay1, double delay2)
+{
+    if (delay1 == 0.0 || (delay2 != 0.0 && delay2 < delay1))
+        return(delay2);
+    return(delay1);
+}
+
+
+/* Return a message for an invalid card/axis to its sender with RA_PROBLEM set. */
+static void reject_message(struct mess_node *node)
+{
+    node->position = 0;
+    node->encoder_position = 0;
+    node->velocity = 0;
+    node->status.All = 0;
+    node->status.Bits.RA_PROBLEM = 1;
+    callbackRequest((CALLBACK *) node);
+}
+
+
+/* Put a message on the tail of the "deferred" list; the list is private to its task, so no lock. */
+static void defer_message(struct circ_queue *deferred, struct mess_node *node)
+{
+    node->next = (struct mess_node *) NULL;
+    if (deferred->tail)
+        deferred->tail->next = node;
+    else
+        deferred->head = node;
+    deferred->tail = node;
+}
+
+
+/* True if the "deferred" list holds a message for this card and axis. */
+static bool axis_deferred(const struct circ_queue *deferred, int card, int axis)
 {
-    struct circ_queue *qptr;
     struct mess_node *node;
 
-    tabptr->quelockptr->wait();
-    qptr = tabptr->queptr;
-    node = qptr->head;
+    for (node = deferred->head; node != NULL; node = node->next)
+        if (node->card == card && node->signal == axis)
+            return(true);
+    return(false);
+}
+
+
+/* Set/clear a card's bit in the driver's "any_motor_in_motion" indicator. */
+static void set_in_motion(struct driver_table *tabptr, int card, bool on)
+{
+    inmotion_lock.wait();
+    if (on == true)
+        SET_MM_ON(*tabptr->any_inmotion_ptr, card);
+    else
+        SET_MM_OFF(*tabptr->any_inmotion_ptr, card);
+    inmotion_lock.signal();
+}
+
 
-    /* delete node from list */
-    if (node)
+/*****************************************************/
+/* Put a message on the tail of a queue */
+/* put_tail_node()                           */
+/*****************************************************/
+static void put_tail_node(struct circ_queue *qptr, epicsEvent *lockptr,
+                          struct mess_node *node)
+{
+    node->next = (struct mess_node *) NULL;
+
+    lockptr->wait();
+    if (qptr->tail)
     {
-        if (node == qptr->head)
-            qptr->head = node->next;
-        if (node == qptr->tail)
-            qptr->tail = NULL;
+        qptr->tail->next = node;
+        qptr->tail = node;
     }
+    else
+    {
+        qptr->tail = node;
+        qptr->head = node;
+    }
+    lockptr->signal();
+}
+
+
+/*****************************************************/
+/* Take all messages off the queue; returns the     */
+/* NULL terminated list in FIFO order.              */
+/* get_all_nodes()                                   */
+/*****************************************************/
+static struct mess_node *get_all_nodes(struct circ_queue *qptr, epicsEvent *lockptr)
+{
+    struct mess_node *node;
 
-    tabptr->quelockptr->signal();
+    lockptr->wait();
+    node = qptr->head;
+    qptr->head = qptr->tail = (struct mess_node *) NULL;
+    lockptr->signal();
 
     return (node);
 }
@@ -477,7 +806,6 @@ static struct mess_node *get_head_node(struct driver_table *tabptr)
 epicsShareFunc RTN_STATUS motor_send(struct mess_node *u_msg, struct driver_table *tabptr)
 {
     struct mess_node *new_message;
-    struct circ_queue *qptr;
 
     new_message = motor_malloc(tabptr->freeptr, tabptr->freelockptr);
     new_message->callback = u_msg->callback;
@@ -506,29 +834,54 @@ epicsShareFunc RTN_STATUS motor_send(struct mess_node *u_msg, struct driver_tabl
             return (ERROR);
     }
 
-    /* Lock queue */
-    tabptr->quelockptr->wait();
+    put_tail_node(tabptr->queptr, tabptr->quelockptr, new_message);
 
-    qptr = tabptr->queptr;
-    if (qptr->tail)
-    {
-        qptr->tail->next = new_message;
-        qptr->tail = new_message;
-    }
-    else
+    tabptr->semptr->signal();
+    return (OK);
+}
+
+/*
+ * FUNCTION... motor_pool_init()
+ *
+ * USAGE... Preallocate MESS_POOL_NODES_PER_AXIS message nodes for every axis
+ *          of the driver, as one block, onto the driver's free list; so that
+ *          motor_send() and query_axis() do not allocate from the heap.
+ */
+
+static void motor_pool_init(struct driver_table *tabptr)
+{
+    struct circ_queue *freelistptr = tabptr->freeptr;
+    struct mess_node *pool;
+    int itera, numaxes = 0, numnodes;
+
+    for (itera = 0; itera < *tabptr->cardcnt_ptr; itera++)
     {
-        qptr->tail = new_message;
-        qptr->head = new_message;
+        struct controller *brdptr = (*tabptr->card_array)[itera];
+        if (brdptr != NULL)
+            numaxes += brdptr->total_axis;
     }
 
+    numnodes = numaxes * MESS_POOL_NODES_PER_AXIS;
+    if (numnodes == 0)
+        return;
+    pool = (struct mess_node *) calloc(numnodes, sizeof(struct mess_node));
+    if (pool == NULL)
+        return;
 
-    /* Unlock message queue */
-    tabptr->quelockptr->signal();
+    for (itera = 0; itera < numnodes - 1; itera++)
+        pool[itera].next = &pool[itera + 1];
 
-    tabptr->semptr->signal();
-    return (OK);
+    tabptr->freelockptr->wait();
+    pool[numnodes - 1].next = freelistptr->head;
+    if (!freelistptr->head)
+        freelistptr->tail = &pool[numnodes - 1];
+    freelistptr->head = pool;
+    tabptr->freelockptr->signal();
+
+    Debug(3, "motor_pool_init: %d message nodes\n", numnodes);
 }
 
+
 static struct mess_node *motor_malloc(struct circ_queue *freelistptr, epicsEvent *lockptr)
 {
     struct mess_node *node;
@@ -34,12 +34,33 @@ typedef struct paramList
     paramIndex nvals;
     int * flags;
     paramIndex * set_flags;
+    paramIndex * dirty;
+    unsigned int nDirty;
     paramVal * vals;
     int forceCallback;
     paramCallback callback;
     void * param;
 } paramList;
 
+/** Marks a parameter as changed since the last callback.
+
+    Changed parameters are appended to a list as they are set, so that paramCallCallback
+    only has to visit the parameters that changed rather than all of them.
+
+    \param params [in]   Pointer to PARAM handle returned by paramCreate.
+    \param i      [in]   Offset of the parameter from startVal.
+
+    \return void.
+*/
+static void paramSetDirty( PARAMS params, paramIndex i )
+{
+    if (!params->flags[i])
+    {
+        params->flags[i] = 1;
+        params->dirty[params->nDirty++] = i + params->startVal;
+    }
+}
+
 /** Deletes a parameter system created by paramCreate.
 
     Allocates data structures for a parameter system with the given number of
@@ -54,6 +75,7 @@ static void paramDestroy( PARAMS params )
 {
     if (params->flags != NULL) free( params->flags );
     if (params->set_flags != NULL) free( params->set_flags );
+    if (params->dirty != NULL) free( params->dirty );
     if (params->vals != NULL) free( params->vals );
     free( params );
     params = NULL;
@@ -78,6 +100,7 @@ static PARAMS paramCreate( paramIndex startVal, paramIndex nvals )
          (params != NULL) &&
          ((params->flags = (int *) calloc( nvals, sizeof(int))) != NULL ) &&
          ((params->set_flags = (paramIndex *) calloc( nvals, sizeof(paramIndex))) != NULL ) &&
+         ((params->dirty = (paramIndex *) calloc( nvals, sizeof(paramIndex))) != NULL ) &&
          ((params->vals = (paramVal *) calloc( nvals, sizeof(paramVal)) ) != NULL ) )
     {
         params->startVal = startVal;
@@ -112,7 +135,7 @@ static int paramSetInteger( PARAMS params, paramIndex index, int value )
         if ( params->vals[index].type != paramInt ||
              params->vals[index].data.ival != value )
         {
-            params->flags[index] = 1;
+            paramSetDirty( params, index );
             params->vals[index].type = paramInt;
             params->vals[index].data.ival = value;
         }
@@ -141,7 +164,7 @@ static int paramSetDouble( PARAMS params, paramIndex index, double value )
         if ( params->vals[index].type != paramDouble ||
              params->vals[index].data.dval != value )
         {
-            params->flags[index] = 1;
+            paramSetDirty( params, index );
             params->vals[index].type = paramDouble;
             params->vals[index].data.dval = value;
         }
@@ -234,7 +257,7 @@ static int paramSetCallback( PARAMS params, paramCallback callback, void * param
     {
         int i;
         for (i = 0; i < params->nvals; i++)
-            if (params->vals[i].type != paramUndef) params->flags[i] = 1;
+            if (params->vals[i].type != paramUndef) paramSetDirty( params, i );
     }
 
     return PARAM_OK;
@@ -252,18 +275,16 @@ static int paramSetCallback( PARAMS params, paramCallback callback, void * param
 static void paramCallCallback( PARAMS params )
 {
     unsigned int i;
-    int nFlags=0;
+    unsigned int nFlags = params->nDirty;
+    paramIndex * changed = params->dirty;
 
-    for (i = 0; i < params->nvals; i++)
-    {
-        if (params->flags[i])
-        {
-            params->set_flags[nFlags] = i + params->startVal;
-            nFlags++;
-            params->flags[i] = 0;
-        }
+    /* Swap the lists, so that parameters set from within the callback are
+       collected for the next call rather than overwriting the ones being passed */
+    params->dirty = params->set_flags;
+    params->set_flags = changed;
+    params->nDirty = 0;
+    for (i = 0; i < nFlags; i++) params->flags[changed[i] - params->startVal] = 0;
 
-    }
     if ( (params->forceCallback || nFlags > 0) && params->callback != NULL )
     {
         if (params->forceCallback)
@@ -88,6 +88,7 @@ using std::endl;
 #include <epicsThread.h>
 #include <epicsExit.h>
 #include <epicsString.h>
+#include <epicsStdio.h>
 #include <iocsh.h>
 
 #include "asynMotorController.h"
@@ -129,9 +130,7 @@ static void shutdownCallback(void *pPvt)
 {
   XPSController *pC = static_cast<XPSController *>(pPvt);
 
-  pC->lock();
-  pC->shuttingDown_ = 1;
-  pC->unlock();
+  pC->shutdown();
 }
 
 // These are the XPSAxis:: methods
@@ -170,6 +169,16 @@ XPSAxis::XPSAxis(XPSController *pC, int axisNo, const char *positionerName, doub
   
   // Assume axis is not moving
   moving_ = false;
+  moveReplied_ = false;
+  moveWatchEvent_ = NULL;
+  moveWatchSuspended_ = 0;
+  if (pC_->moveWatcher_) startMoveWatcher();
+  axisStatus_ = 0;
+  statusString_ = NULL;
+  readStatusString_ = false;
+  readLimits_ = false;
+  limitsValid_ = false;
+  limitsStatus_ = 0;
 
   index = (char *)strchr(positionerName, '.');
   if (index == NULL) {
@@ -267,10 +276,12 @@ asynStatus XPSAxis::move(double position, int relative, double min_velocity, dou
   deviceUnits = position * stepSize_;
   if (relative) {
     if (pC_->movesDeferred_ == 0) {
+      acquireMoveSocket();
       status = GroupMoveRelative(moveSocket_,
                                  positionerName_,
                                  1,
                                  &deviceUnits); 
+      releaseMoveSocket();
       if (status != 0 && status != -27) {
         asynPrint(pasynUser_, ASYN_TRACE_ERROR,
                   "%s:%s: Error performing GroupMoveRelative[%s,%d] %d\n",
@@ -279,6 +290,7 @@ asynStatus XPSAxis::move(double position, int relative, double min_velocity, dou
         return asynError;
       }
       moving_ = true;
+      moveReplied_ = false;
     } else {
       deferredPosition_ = deviceUnits;
       deferredMove_ = true;
@@ -286,10 +298,12 @@ asynStatus XPSAxis::move(double position, int relative, double min_velocity, dou
     }
   } else {
     if (pC_->movesDeferred_ == 0) {
+      acquireMoveSocket();
       status = GroupMoveAbsolute(moveSocket_,
                                  positionerName_,
                                  1,
                                  &deviceUnits); 
+      releaseMoveSocket();
       if (status != 0 && status != -27) {
         asynPrint(pasynUser_, ASYN_TRACE_ERROR,
                   "%s:%s: Error performing GroupMoveAbsolute[%s,%d] %d\n",
@@ -298,6 +312,7 @@ asynStatus XPSAxis::move(double position, int relative, double min_velocity, dou
         return asynError;
       }
       moving_ = true;
+      moveReplied_ = false;
     } else {
       deferredPosition_ = deviceUnits;
       deferredMove_ = true;
@@ -347,7 +362,9 @@ asynStatus XPSAxis::home(double min_velocity, double max_velocity, double accele
       return asynError;
     }
   }
+  acquireMoveSocket();
   status = GroupHomeSearch(moveSocket_, groupName_);
+  releaseMoveSocket();
   if (status) {
     asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
               "%s:%s: [%s,%d]: error calling GroupHomeSearch error=%s\n",
@@ -355,6 +372,7 @@ asynStatus XPSAxis::home(double min_velocity, double max_velocity, double accele
     return asynError;
   }
   moving_ = true;
+  moveReplied_ = false;
 
   setIntegerParam(pC_->motorStatusProblem_, 0);
 
@@ -377,7 +395,9 @@ asynStatus XPSAxis::moveVelocity(double min_velocity, double max_velocity, doubl
   }
   deviceVelocity = max_velocity * stepSize_;
   deviceAcceleration = acceleration * stepSize_;
+  acquireMoveSocket();
   status = GroupJogParametersSet(moveSocket_, positionerName_, 1, &deviceVelocity, &deviceAcceleration);
+  releaseMoveSocket();
   if (status) {
     asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
               "%s:%s: [%s,%d]: error calling GroupJogParametersSet error=%d\n",
@@ -385,6 +405,7 @@ asynStatus XPSAxis::moveVelocity(double min_velocity, double max_velocity, doubl
     return asynError;
   }
   moving_ = true;
+  moveReplied_ = false;
 
   return asynSuccess;
 }
@@ -511,8 +532,13 @@ asynStatus XPSAxis::setPosition(double position)
 asynStatus XPSAxis::stop(double acceleration)
 {
   int status;
+  int stopSocket;
   static const char *functionName = "stopAxis";
 
+  /* With the move watcher the moveSocket is waiting for the reply to the move, so the stop is sent
+   * on the pollSocket.  The XPS then sends the reply to the aborted move, which the watcher reads. */
+  stopSocket = pC_->moveWatcher_ ? pollSocket_ : moveSocket_;
+
   /* We need to read the status, because a jog is stopped differently from a move */ 
   status = GroupStatusGet(pollSocket_, groupName_, &axisStatus_);
   if (status) {
@@ -523,18 +549,18 @@ asynStatus XPSAxis::stop(double acceleration)
   }
   
   if ((axisStatus_ == 44) || (axisStatus_ == 45) || (axisStatus_ == 47)) {
-    status = GroupMoveAbort(moveSocket_, groupName_);
+    status = GroupMoveAbort(stopSocket, groupName_);
     if (status) {
       asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
                 "%s:%s: [%s,%d]: error calling GroupMoveAbort status=%d\n",
                 driverName, functionName, pC_->portName, axisNo_, status);
-      GroupMoveAbort(moveSocket_, groupName_);
+      GroupMoveAbort(stopSocket, groupName_);
       return asynError;
     }
   }
 
   if (axisStatus_ == 43) {
-    status = GroupKill(moveSocket_, groupName_);
+    status = GroupKill(stopSocket, groupName_);
     if (status) {
       asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
                 "%s:%s: [%s,%d]: error calling GroupKill status=%d\n",
@@ -553,20 +579,110 @@ asynStatus XPSAxis::stop(double acceleration)
   return asynSuccess;
 }
 
-asynStatus XPSAxis::poll(bool *moving)
+static void XPSMoveWatchThreadC(void *pPvt)
+{
+  XPSAxis *pAxis = (XPSAxis*)pPvt;
+  pAxis->moveWatchThread();
+}
+
+/** Starts the move watcher thread for this axis, if it is not already running. */
+void XPSAxis::startMoveWatcher()
+{
+  if (moveWatchEvent_) return;
+  moveWatchEvent_ = epicsEventMustCreate(epicsEventEmpty);
+  epicsThreadCreate("XPSMoveWatch", 
+                    epicsThreadPriorityMedium,
+                    epicsThreadGetStackSize(epicsThreadStackMedium),
+                    (EPICSTHREADFUNC)XPSMoveWatchThreadC, (void *)this);
+}
+
+/** Move watcher thread, started by XPSController::enableMoveWatcher().
+  * The XPS replies to a move command on the moveSocket when the move completes.
+  * While the axis is moving this thread waits for that reply in a blocking read, without
+  * the controller lock, so the reply is seen as soon as it arrives.  It then takes the lock
+  * only to set moveReplied_, and wakes up the poller.
+  * ReadXPSSocket() holds the socket lock for the whole read, so a command cannot be sent on the
+  * moveSocket while the read is waiting.  Commands take the socket with acquireMoveSocket(),
+  * which suspends this thread; stop() uses the pollSocket instead.  The read has a timeout
+  * of moveWatchTimeout_, so a suspended thread gives up the socket within that time.
+  * When the axis is not moving the thread waits for XPSController::wakeupPoller(). */
+void XPSAxis::moveWatchThread()
+{
+  int status;
+  bool idle;
+  char readResponse[25];
+  static const char *functionName = "moveWatchThread";
+
+  while (!pC_->shuttingDown_) {
+    pC_->lock();
+    idle = !moving_ || moveReplied_ || (moveWatchSuspended_ > 0);
+    pC_->unlock();
+    if (idle) {
+      epicsEventWaitWithTimeout(moveWatchEvent_, XPS_MOVE_WATCH_IDLE_TIMEOUT);
+      continue;
+    }
+    status = ReadXPSSocket(moveSocket_, readResponse, sizeof(readResponse), pC_->moveWatchTimeout_);
+    if (status < 0) {
+      epicsThreadSleep(XPS_MOVE_WATCH_IDLE_TIMEOUT);
+      continue;
+    }
+    if (status == 0) continue;
+    asynPrint(pasynUser_, ASYN_TRACE_FLOW, 
+              "%s:%s: [%s,%d]: readXPSSocket returned nRead=%d, [%s]\n",
+              driverName, functionName, pC_->portName, axisNo_, status, readResponse);
+    pC_->lock();
+    if (moving_) moveReplied_ = true;
+    pC_->unlock();
+    pC_->asynMotorController::wakeupPoller();
+  }
+}
+
+/** Takes the moveSocket from the move watcher thread before a command is sent on it.
+  * The watcher is suspended so it does not start another read, and this waits for the read
+  * it may be doing to finish.  A move reply that is already waiting on the socket is discarded,
+  * so the command does not take it for its own reply; the previous move is then seen to be done
+  * from the group status.  The caller must call releaseMoveSocket() when it is done, and must not
+  * take the controller lock in between unless it already holds it. */
+void XPSAxis::acquireMoveSocket()
 {
   int status;
   char readResponse[25];
-  char statusString[MAX_MESSAGE_LEN] = {0};
+  static const char *functionName = "acquireMoveSocket";
+
+  pC_->lock();
+  moveWatchSuspended_++;
+  pC_->unlock();
+  LockXPSSocket(moveSocket_);
+  if (!pC_->moveWatcher_) return;
+  status = ReadXPSSocket(moveSocket_, readResponse, sizeof(readResponse), 0);
+  if (status > 0) {
+    asynPrint(pasynUser_, ASYN_TRACE_FLOW, 
+              "%s:%s: [%s,%d]: discarded move reply nRead=%d, [%s]\n",
+              driverName, functionName, pC_->portName, axisNo_, status, readResponse);
+  }
+}
+
+/** Gives the moveSocket back to the move watcher thread.  See acquireMoveSocket(). */
+void XPSAxis::releaseMoveSocket()
+{
+  UnlockXPSSocket(moveSocket_);
+  pC_->lock();
+  moveWatchSuspended_--;
+  pC_->unlock();
+  if (moveWatchEvent_) epicsEventSignal(moveWatchEvent_);
+}
+
+asynStatus XPSAxis::poll(bool *moving)
+{
+  int status;
   static const char *functionName = "poll";
 
   status = GroupStatusGet(pollSocket_, 
                           groupName_, 
                           &axisStatus_);
   if (!status) {
-    status = GroupStatusStringGet(pollSocket_,
-                                  axisStatus_,
-                                  statusString); 
+    /* The status string only depends on axisStatus_, so it comes from the controller's cache */
+    status = pC_->getStatusString(axisStatus_, &statusString_);
   }
   if (status) {
     asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
@@ -574,12 +690,88 @@ asynStatus XPSAxis::poll(bool *moving)
               driverName, functionName, pC_->portName, axisNo_, status);
     goto done;
   }
+  status = setGroupStatus(statusString_, moving);
+  if (status) goto done;
+
+  /*Read the controller software limits in case these have been changed by a TCL script.*/
+  if (limitsStale()) {
+    status = PositionerUserTravelLimitsGet(pollSocket_, positionerName_, &lowLimit_, &highLimit_);
+    if (status == 0) setTravelLimits();
+  }
+
+  status = GroupPositionCurrentGet(pollSocket_,
+                                   positionerName_,
+                                   1,
+                                   &encoderPosition_);
+  if (status) {
+    asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
+              "%s:%s: [%s,%d]: error calling GroupPositionCurrentGet status=%d\n",
+              driverName, functionName, pC_->portName, axisNo_, status);
+    goto done;
+  }
+  setDoubleParam(pC_->motorEncoderPosition_, (encoderPosition_/stepSize_));
+
+  status = GroupPositionSetpointGet(pollSocket_,
+                                   positionerName_,
+                                   1,
+                                   &setpointPosition_);
+  if (status) {
+    asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
+              "%s:%s: [%s,%d]: error calling GroupPositionSetpointGet status=%d\n",
+              driverName, functionName, pC_->portName, axisNo_, status);
+    goto done;
+  }
+  setDoubleParam(pC_->motorPosition_, (setpointPosition_/stepSize_));
+
+  status = PositionerErrorGet(pollSocket_,
+                              positionerName_,
+                              &positionerError_);
+  if (status) {
+    asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
+              "%s:%s: [%s,%d]: error calling PositionerErrorGet status=%d\n",
+               driverName, functionName, pC_->portName, axisNo_, status);
+    goto done;
+  }
+  setPositionerError();
+
+  /* Read the current velocity and use it set motor direction and moving flag. */
+  status = GroupVelocityCurrentGet(pollSocket_,
+                                   positionerName_,
+                                   1,
+                                   &currentVelocity_);
+  if (status) {
+    asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
+              "%s:%s: [%s,%d]: error calling GroupPositionVelocityGet status=%d\n",
+              driverName, functionName, pC_->portName, axisNo_,  status);
+    goto done;
+  }
+  setCurrentVelocity();
+  
+  done:
+  setIntegerParam(pC_->motorStatusCommsError_, status ? 1 : 0);
+  callParamCallbacks();
+  return status ? asynError : asynSuccess;
+}
+
+/** Sets the status parameters that are derived from the group state in axisStatus_.
+  * Also determines whether the axis is moving, reading the moveSocket_ if
+  * XPSController::enableMovingMode() has been called.
+  * \param[in] statusString The group status string, or NULL if it has not changed.
+  * \param[out] moving Set to true if the axis is moving.
+  * Returns 0 on success, or non-zero if there was an error reading the moveSocket_. */
+int XPSAxis::setGroupStatus(const char *statusString, bool *moving)
+{
+  int status;
+  char readResponse[25];
+  static const char *functionName = "setGroupStatus";
+
   asynPrint(pasynUser_, ASYN_TRACE_FLOW, 
             "%s:%s: [%s,%d]: %s axisStatus=%d, statusString=%s\n",
-            driverName, functionName, pC_->portName, axisNo_, positionerName_, axisStatus_, statusString);
+            driverName, functionName, pC_->portName, axisNo_, positionerName_, axisStatus_, 
+            statusString ? statusString : "(unchanged)");
   /* Set the status */
   setIntegerParam(pC_->XPSStatus_, axisStatus_);
-  setStringParam(pC_->XPSStatusString_, statusString);
+  if (statusString) setStringParam(pC_->XPSStatusString_, statusString);
   
   /* Previously we set the motion done flag by seeing if axisStatus_ was >=43 && <= 48, which means moving,
    * homing, jogging, etc.  However, this information is about the group, not the axis, so if one
@@ -601,19 +793,21 @@ asynStatus XPSAxis::poll(bool *moving)
    * We currently assume the move is complete if we get any response, we don't
    * check the actual response. */
   if (pC_->enableMovingMode_) {
-    if (moving_) {
+    if (moving_ && pC_->moveWatcher_) {
+      /* The move watcher thread reads the moveSocket */
+      if (moveReplied_) moving_ = false;
+    } else if (moving_) {
       status = ReadXPSSocket(moveSocket_, readResponse, sizeof(readResponse), 0);
       if (status < 0) {
         asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
                   "%s:%s: [%s,%d]: error calling ReadXPSSocket status=%d\n",
                   driverName, functionName, pC_->portName, axisNo_,  status);
-        goto done;
+        return status;
       }
       if (status > 0) {
         asynPrint(pasynUser_, ASYN_TRACE_FLOW, 
                   "%s:%s: [%s,%d]: readXPSSocket returned nRead=%d, [%s]\n",
                   driverName, functionName, pC_->portName, axisNo_,  status, readResponse);
-        status = 0;
         moving_ = false;
       }
     }
@@ -624,13 +818,6 @@ asynStatus XPSAxis::poll(bool *moving)
   if (deferredMove_) *moving = true;
   setIntegerParam(pC_->motorStatusDone_, *moving?0:1);
 
-  /*Read the controller software limits in case these have been changed by a TCL script.*/
-  status = PositionerUserTravelLimitsGet(pollSocket_, positionerName_, &lowLimit_, &highLimit_);
-  if (status == 0) {
-    setDoubleParam(pC_->motorHighLimit_, (highLimit_/stepSize_));
-    setDoubleParam(pC_->motorLowLimit_, (lowLimit_/stepSize_));
-  }
-
   /* Set the ATHM signal.*/
   if (axisStatus_ == 11) {
     if (referencingMode_ == 0) {
@@ -681,66 +868,210 @@ asynStatus XPSAxis::poll(bool *moving)
   } else {
     setIntegerParam(pC_->motorStatusProblem_, 0);
   }
+  return 0;
+}
 
-  status = GroupPositionCurrentGet(pollSocket_,
-                                   positionerName_,
-                                   1,
-                                   &encoderPosition_);
+/** Returns true if the travel limits should be read from the controller.
+  * The limits rarely change, so they are only read when the group state changes,
+  * after they have been set, and otherwise every XPSController::limitsRefreshPeriod_ seconds. */
+bool XPSAxis::limitsStale()
+{
+  epicsTimeStamp now;
+  bool stale;
+
+  epicsTimeGetCurrent(&now);
+  stale = (!limitsValid_ || (axisStatus_ != limitsStatus_) ||
+           (epicsTimeDiffInSeconds(&now, &limitsTime_) >= pC_->limitsRefreshPeriod_));
+  if (stale) pC_->limitsMisses_++;
+  else       pC_->limitsHits_++;
+  return stale;
+}
+
+/** Sets the limit parameters from lowLimit_ and highLimit_ and records when they were read. */
+void XPSAxis::setTravelLimits()
+{
+  setDoubleParam(pC_->motorHighLimit_, (highLimit_/stepSize_));
+  setDoubleParam(pC_->motorLowLimit_, (lowLimit_/stepSize_));
+  limitsValid_ = true;
+  limitsStatus_ = axisStatus_;
+  epicsTimeGetCurrent(&limitsTime_);
+}
+
+/** Sets the hard limit status bits from positionerError_. */
+void XPSAxis::setPositionerError()
+{
+  /* These are hard limits */
+  if (positionerError_ & XPSC8_END_OF_RUN_PLUS) {
+    setIntegerParam(pC_->motorStatusHighLimit_, 1);
+  } else {
+    setIntegerParam(pC_->motorStatusHighLimit_, 0);
+  }
+  if (positionerError_ & XPSC8_END_OF_RUN_MINUS) {
+    setIntegerParam(pC_->motorStatusLowLimit_, 1);
+  } else {
+    setIntegerParam(pC_->motorStatusLowLimit_, 0);
+  }
+}
+
+/** Sets the direction and moving status bits from currentVelocity_. */
+void XPSAxis::setCurrentVelocity()
+{
+  setIntegerParam(pC_->motorStatusDirection_, (currentVelocity_ > XPS_VELOCITY_DEADBAND));
+  setIntegerParam(pC_->motorStatusMoving_,    (fabs(currentVelocity_) > XPS_VELOCITY_DEADBAND));
+}
+
+/** Appends the XPS API commands needed to poll this axis to a command buffer.
+  * Used by XPSController::pollAll() when pipelined polling is enabled.
+  * The replies must be passed to pollReplies() in the same order.
+  * \param[in,out] buffer The command buffer to append to.
+  * \param[in] bufferSize The total size of buffer.
+  * Returns the number of commands appended, or -1 if the buffer is too small. */
+int XPSAxis::appendPollCommands(char *buffer, size_t bufferSize)
+{
+  size_t len = strlen(buffer);
+  int nchars;
+
+  nchars = epicsSnprintf(buffer+len, bufferSize-len,
+                         "GroupStatusGet (%s,int *)"
+                         "GroupPositionCurrentGet (%s,double *)"
+                         "GroupPositionSetpointGet (%s,double *)"
+                         "PositionerErrorGet (%s,int *)"
+                         "GroupVelocityCurrentGet (%s,double *)",
+                         groupName_, positionerName_, positionerName_,
+                         positionerName_, positionerName_);
+  if ((nchars < 0) || ((size_t)nchars >= bufferSize-len)) {
+    buffer[len] = 0;
+    return -1;
+  }
+  return XPS_POLL_COMMANDS;
+}
+
+/** Appends the commands whose need depends on the group status to a command buffer.
+  * These are GroupStatusStringGet if the status string is not in the controller's cache,
+  * and PositionerUserTravelLimitsGet if the cached travel limits are stale.
+  * Used by XPSController::pollAll() for the second request of a pipelined poll.
+  * \param[in,out] buffer The command buffer to append to.
+  * \param[in] bufferSize The total size of buffer.
+  * \param[in] groupStatusReply The reply to the GroupStatusGet command.
+  * Returns the number of commands appended. */
+int XPSAxis::appendStatusCommands(char *buffer, size_t bufferSize, const char *groupStatusReply)
+{
+  size_t len;
+  int numCommands = 0;
+
+  readStatusString_ = false;
+  readLimits_ = false;
+  if (parseGroupStatus(groupStatusReply)) return 0;
+  statusString_ = pC_->findStatusString(axisStatus_);
+  if (!statusString_) {
+    len = strlen(buffer);
+    epicsSnprintf(buffer+len, bufferSize-len, "GroupStatusStringGet (%d,char *)", axisStatus_);
+    readStatusString_ = true;
+    numCommands++;
+  }
+  if (limitsStale()) {
+    len = strlen(buffer);
+    epicsSnprintf(buffer+len, bufferSize-len, 
+                  "PositionerUserTravelLimitsGet (%s,double *,double *)", positionerName_);
+    readLimits_ = true;
+    numCommands++;
+  }
+  return numCommands;
+}
+
+/** Sets axisStatus_ from the GroupStatusGet reply of a pipelined poll.
+  * \param[in] reply The reply to the first command appended by appendPollCommands().
+  * Returns the XPS error code, 0 on success. */
+int XPSAxis::parseGroupStatus(const char *reply)
+{
+  int status = -1;
+  int groupStatus;
+
+  if (sscanf(reply, "%d,%d", &status, &groupStatus) == 2 && status == 0) {
+    axisStatus_ = groupStatus;
+  } else if (status == 0) {
+    status = -1;
+  }
+  return status;
+}
+
+/** Sets the parameters for this axis from the replies of a pipelined poll.
+  * This is the equivalent of poll() for XPSController::pollAll().
+  * \param[in] replies The XPS_POLL_COMMANDS replies to the commands appended by appendPollCommands().
+  * \param[in] statusReplies The replies to the commands appended by appendStatusCommands(),
+  *            or NULL if that request failed.
+  * \param[out] moving Set to true if the axis is moving. */
+asynStatus XPSAxis::pollReplies(char **replies, char **statusReplies, bool *moving)
+{
+  int status;
+  int nextReply = 0;
+  char statusString[MAX_MESSAGE_LEN];
+  static const char *functionName = "pollReplies";
+
+  *moving = moving_;
+  status = parseGroupStatus(replies[0]);
   if (status) {
     asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
-              "%s:%s: [%s,%d]: error calling GroupPositionCurrentGet status=%d\n",
+              "%s:%s: [%s,%d]: error in GroupStatusGet reply status=%d\n",
               driverName, functionName, pC_->portName, axisNo_, status);
     goto done;
   }
+  if (readStatusString_) {
+    if (statusReplies && 
+        (XPSController::parseStatusStringReply(statusReplies[nextReply], statusString, sizeof(statusString)) == 0)) {
+      statusString_ = pC_->cacheStatusString(axisStatus_, statusString);
+    }
+    nextReply++;
+  }
+  status = setGroupStatus(statusString_, moving);
+  if (status) goto done;
+
+  if (readLimits_) {
+    if (statusReplies &&
+        (sscanf(statusReplies[nextReply], "%d,%lf,%lf", &status, &lowLimit_, &highLimit_) == 3) && 
+        (status == 0)) {
+      setTravelLimits();
+    }
+    status = 0;
+    nextReply++;
+  }
+
+  if ((sscanf(replies[1], "%d,%lf", &status, &encoderPosition_) != 2) || status) {
+    asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
+              "%s:%s: [%s,%d]: error in GroupPositionCurrentGet reply [%s]\n",
+              driverName, functionName, pC_->portName, axisNo_, replies[1]);
+    if (!status) status = -1;
+    goto done;
+  }
   setDoubleParam(pC_->motorEncoderPosition_, (encoderPosition_/stepSize_));
 
-  status = GroupPositionSetpointGet(pollSocket_,
-                                   positionerName_,
-                                   1,
-                                   &setpointPosition_);
-  if (status) {
+  if ((sscanf(replies[2], "%d,%lf", &status, &setpointPosition_) != 2) || status) {
     asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
-              "%s:%s: [%s,%d]: error calling GroupPositionSetpointGet status=%d\n",
-              driverName, functionName, pC_->portName, axisNo_, status);
+              "%s:%s: [%s,%d]: error in GroupPositionSetpointGet reply [%s]\n",
+              driverName, functionName, pC_->portName, axisNo_, replies[2]);
+    if (!status) status = -1;
     goto done;
   }
   setDoubleParam(pC_->motorPosition_, (setpointPosition_/stepSize_));
 
-  status = PositionerErrorGet(pollSocket_,
-                              positionerName_,
-                              &positionerError_);
-  if (status) {
+  if ((sscanf(replies[3], "%d,%d", &status, &positionerError_) != 2) || status) {
     asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
-              "%s:%s: [%s,%d]: error calling PositionerErrorGet status=%d\n",
-               driverName, functionName, pC_->portName, axisNo_, status);
+              "%s:%s: [%s,%d]: error in PositionerErrorGet reply [%s]\n",
+              driverName, functionName, pC_->portName, axisNo_, replies[3]);
+    if (!status) status = -1;
     goto done;
   }
-  /* These are hard limits */
-  if (positionerError_ & XPSC8_END_OF_RUN_PLUS) {
-    setIntegerParam(pC_->motorStatusHighLimit_, 1);
-  } else {
-    setIntegerParam(pC_->motorStatusHighLimit_, 0);
-  }
-  if (positionerError_ & XPSC8_END_OF_RUN_MINUS) {
-    setIntegerParam(pC_->motorStatusLowLimit_, 1);
-  } else {
-    setIntegerParam(pC_->motorStatusLowLimit_, 0);
-  }
+  setPositionerError();
 
-  /* Read the current velocity and use it set motor direction and moving flag. */
-  status = GroupVelocityCurrentGet(pollSocket_,
-                                   positionerName_,
-                                   1,
-                                   &currentVelocity_);
-  if (status) {
+  if ((sscanf(replies[4], "%d,%lf", &status, &currentVelocity_) != 2) || status) {
     asynPrint(pasynUser_, ASYN_TRACE_ERROR, 
-              "%s:%s: [%s,%d]: error calling GroupPositionVelocityGet status=%d\n",
-              driverName, functionName, pC_->portName, axisNo_,  status);
+              "%s:%s: [%s,%d]: error in GroupVelocityCurrentGet reply [%s]\n",
+              driverName, functionName, pC_->portName, axisNo_, replies[4]);
+    if (!status) status = -1;
     goto done;
   }
-  setIntegerParam(pC_->motorStatusDirection_, (currentVelocity_ > XPS_VELOCITY_DEADBAND));
-  setIntegerParam(pC_->motorStatusMoving_,    (fabs(currentVelocity_) > XPS_VELOCITY_DEADBAND));
-  
+  setCurrentVelocity();
+
   done:
   setIntegerParam(pC_->motorStatusCommsError_, status ? 1 : 0);
   callParamCallbacks();
@@ -779,6 +1110,8 @@ asynStatus XPSAxis::setLowLimit(double value)
             driverName, functionName, pC_->portName, axisNo_, deviceValue);
   
   done:
+  /* Force the limits to be read back on the next poll */
+  limitsValid_ = false;
   return (asynStatus)status;
 }
 
@@ -815,6 +1148,8 @@ asynStatus XPSAxis::setHighLimit(double value)
             driverName, functionName, pC_->portName, axisNo_, deviceValue);
   
   done:
+  /* Force the limits to be read back on the next poll */
+  limitsValid_ = false;
   return (asynStatus)status;
 }
 
@@ -1625,7 +1960,9 @@ asynStatus XPSAxis::doMoveToHome(void)
      * If the group is Ready, then make it not Ready  */
   status = GroupStatusGet(pollSocket_, groupName_, &groupStatus);
   if (groupStatus >= 10 && groupStatus <= 18) {
+    acquireMoveSocket();
     status = GroupKill(moveSocket_, groupName_);
+    releaseMoveSocket();
   }
   epicsThreadSleep(0.05);
   status = GroupInitialize(pollSocket_, groupName_);
@@ -1634,9 +1971,13 @@ asynStatus XPSAxis::doMoveToHome(void)
     return asynError;
   }
   epicsThreadSleep(0.05);
+  acquireMoveSocket();
   status = GroupReferencingStart(moveSocket_, groupName_);
+  releaseMoveSocket();
   epicsThreadSleep(0.05);
+  acquireMoveSocket();
   status = GroupReferencingStop(moveSocket_, groupName_);
+  releaseMoveSocket();
   epicsThreadSleep(0.05);
 
   status = GroupStatusGet(pollSocket_, groupName_, &groupStatus);
@@ -1679,7 +2020,9 @@ asynStatus XPSAxis::doMoveToHome(void)
                                          &vel, &accel, &minJerk, &maxJerk);
   if (status != 0) {
     asynPrint(pasynUser_, ASYN_TRACE_ERROR, "%s:%s: Error performing PositionerSGammaParametersGet.\n", driverName, functionName);
+    acquireMoveSocket();
     GroupKill(moveSocket_, groupName_);
+    releaseMoveSocket();
     return asynError;
 
   }
@@ -1688,18 +2031,24 @@ asynStatus XPSAxis::doMoveToHome(void)
                                          (vel/2), accel, minJerk, maxJerk);
   if (status != 0) {
     asynPrint(pasynUser_, ASYN_TRACE_ERROR, "%s:%s: Error performing PositionerSGammaParametersSet.\n", driverName, functionName);
+    acquireMoveSocket();
     GroupKill(moveSocket_, groupName_);
+    releaseMoveSocket();
     return asynError;
   }
   epicsThreadSleep(0.05);
   
   /*Move in direction of home switch.*/
+  acquireMoveSocket();
   status = GroupMoveRelative(moveSocket_, positionerName_, 1,
                              &defaultDistance); 
+  releaseMoveSocket();
   if (status != 0) {
     asynPrint(pasynUser_, ASYN_TRACE_ERROR, "%s:%s: Error performing GroupMoveRelative.\n", driverName, functionName);
     /*Issue a kill here if we have failed to move.*/
+    acquireMoveSocket();
     status = GroupKill(moveSocket_, groupName_);
+    releaseMoveSocket();
     return asynError;
   }
   
@@ -1719,14 +2068,18 @@ asynStatus XPSAxis::doMoveToHome(void)
         /* move finished for some other reason.*/
         asynPrint(pasynUser_, ASYN_TRACE_ERROR, "%s:%s: Error performing GroupMoveRelative.\n", driverName, functionName);
         /*Issue a kill here if we have failed to move.*/
+        acquireMoveSocket();
         status = GroupKill(moveSocket_, groupName_);
+        releaseMoveSocket();
         return asynError;
       }
     }
   } else {
     asynPrint(pasynUser_, ASYN_TRACE_ERROR, "%s:%s: Error performing GroupMoveRelative.\n", driverName, functionName);
     /*Issue a kill here if we have failed to move.*/
+    acquireMoveSocket();
     status = GroupKill(moveSocket_, groupName_);
+    releaseMoveSocket();
     return asynError;
   }
 
@@ -1734,7 +2087,9 @@ asynStatus XPSAxis::doMoveToHome(void)
   if (status != 0) {
     asynPrint(pasynUser_, ASYN_TRACE_ERROR, "%s:%s: Error performing GroupMoveAbort.\n", driverName, functionName);
     /*This should really have worked. Do a kill instead.*/
+    acquireMoveSocket();
     status = GroupKill(moveSocket_, groupName_);
+    releaseMoveSocket();
     return asynError;
   }
 
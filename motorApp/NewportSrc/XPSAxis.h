@@ -5,9 +5,14 @@ USAGE...        Newport XPS EPICS asyn motor device driver
 #ifndef XPSMotorAxis_H
 #define XPSMotorAxis_H
 
+#include <epicsTime.h>
+
 #include "asynMotorController.h"
 #include "asynMotorAxis.h"
 
+/** Number of XPS API commands sent for each axis by a pipelined poll.*/
+#define XPS_POLL_COMMANDS 5
+
 /** Struct that contains information about the XPS corrector loop.*/ 
 typedef struct
 {
@@ -50,6 +55,14 @@ class epicsShareClass XPSAxis : public asynMotorAxis
   asynStatus setClosedLoop(bool closedLoop);
   asynStatus setPositionCompare();
   asynStatus getPositionCompare();
+  int appendPollCommands(char *buffer, size_t bufferSize);
+  int appendStatusCommands(char *buffer, size_t bufferSize, const char *groupStatusReply);
+  int parseGroupStatus(const char *reply);
+  asynStatus pollReplies(char **replies, char **statusReplies, bool *moving);
+  void startMoveWatcher();
+  void moveWatchThread();
+  void acquireMoveSocket();
+  void releaseMoveSocket();
 
   virtual asynStatus defineProfile(double *positions, size_t numPoints);
   virtual asynStatus readbackProfile();
@@ -58,6 +71,11 @@ class epicsShareClass XPSAxis : public asynMotorAxis
   XPSController *pC_;
   char *getXPSError(int status, char *buffer);
   int isInGroup();
+  int setGroupStatus(const char *statusString, bool *moving);
+  void setPositionerError();
+  bool limitsStale();
+  void setTravelLimits();
+  void setCurrentVelocity();
   asynStatus setPID(const double * value, int pidoption);
   asynStatus getPID();
   asynStatus setPIDValue(const double * value, int pidoption);
@@ -90,7 +108,16 @@ class epicsShareClass XPSAxis : public asynMotorAxis
   char *groupName_;
   int positionerError_;
   int axisStatus_;
+  const char *statusString_;   /**< Status string for axisStatus_, points into the controller's cache */
+  bool readStatusString_;      /**< The pipelined poll requested the status string */
+  bool readLimits_;            /**< The pipelined poll requested the travel limits */
+  bool limitsValid_;           /**< lowLimit_ and highLimit_ have been read since they were last set */
+  int limitsStatus_;           /**< The value of axisStatus_ when the limits were last read */
+  epicsTimeStamp limitsTime_;  /**< The time when the limits were last read */
   bool moving_;
+  bool moveReplied_;           /**< The move watcher thread has received the reply to the last move */
+  epicsEventId moveWatchEvent_; /**< Wakes up the move watcher thread when a move starts */
+  int moveWatchSuspended_;     /**< Number of threads that have taken the moveSocket with acquireMoveSocket() */
   double profilePreDistance_;
   double profilePostDistance_;
   xpsCorrectorInfo_t xpsCorrectorInfo_;
@@ -84,6 +84,7 @@ Versions: Release 4-5 and higher.
 #include <epicsTime.h>
 #include <epicsThread.h>
 #include <epicsString.h>
+#include <epicsStdlib.h>
 #include <iocsh.h>
 #include <asynDriver.h>
 
@@ -94,6 +95,7 @@ Versions: Release 4-5 and higher.
 #include "XPSController.h"
 #include "XPS_C8_drivers.h"
 #include "xps_ftp.h"
+#include "asynOctetSocket.h"
 #include "XPSAxis.h"
 
 static const char *driverName = "XPSController";
@@ -190,6 +192,30 @@ XPSController::XPSController(const char *portName, const char *IPAddress, int IP
   }
   
   FirmwareVersionGet(pollSocket_, firmwareVersion_);
+
+  // Cache the status strings, they only depend on the status code
+  memset(statusStrings_, 0, sizeof(statusStrings_));
+  statusStringHits_ = 0;
+  statusStringMisses_ = 0;
+  limitsHits_ = 0;
+  limitsMisses_ = 0;
+  limitsRefreshPeriod_ = XPS_DEFAULT_LIMITS_REFRESH_PERIOD;
+  initStatusStrings();
+
+  /* Flag to enable the move watcher thread.
+   * This must be initialized before the poller starts because it is used by wakeupPoller().*/
+  /* See function XPSController::enableMoveWatcher().*/
+  moveWatcher_ = false;
+  moveWatchTimeout_ = XPS_DEFAULT_MOVE_WATCH_TIMEOUT;
+
+  gatheringLinesPerRead_ = 0;
+
+  profileBuildPositions_ = NULL;
+  trajectory_ = NULL;
+  trajectorySize_ = 0;
+  trajectoryLength_ = 0;
+  ftpConnected_ = false;
+  profileSocket_ = -1;
   
   /* Create the poller thread for this controller
    * NOTE: at this point the axis objects don't yet exist, but the poller tolerates this */
@@ -217,6 +243,13 @@ XPSController::XPSController(const char *portName, const char *IPAddress, int IP
   /* See function XPSController::enableMovingMode().*/
   enableMovingMode_ = false;
 
+  /* Flag to enable pipelined polling of all axes.*/
+  /* See function XPSController::enablePipelinedPoll().*/
+  pipelinedPoll_ = false;
+  pollCommands_ = NULL;
+  pollReplies_ = NULL;
+  pollReplyPtrs_ = NULL;
+
 }
 
 void XPSController::report(FILE *fp, int level)
@@ -237,6 +270,12 @@ void XPSController::report(FILE *fp, int level)
     fprintf(fp, "           movesDeferred: %d\n", movesDeferred_);
     fprintf(fp, "              autoEnable: %d\n", autoEnable_);
     fprintf(fp, "          noDisableError: %d\n", noDisableError_);
+    fprintf(fp, "        enableMovingMode: %d\n", enableMovingMode_);
+    fprintf(fp, "           pipelinedPoll: %d\n", pipelinedPoll_);
+    fprintf(fp, "             moveWatcher: %d, timeout: %f\n", moveWatcher_, moveWatchTimeout_);
+    fprintf(fp, "   limits refresh period: %f\n", limitsRefreshPeriod_);
+    fprintf(fp, "  status string cache hits: %lu, misses: %lu\n", statusStringHits_, statusStringMisses_);
+    fprintf(fp, "  travel limits cache hits: %lu, misses: %lu\n", limitsHits_, limitsMisses_);
   }
 
   // Call the base class method
@@ -265,8 +304,10 @@ asynStatus XPSController::writeInt32(asynUser *pasynUser, epicsInt32 value)
       asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW, 
                 "Executing TCL script %s on XPS: %s\n", 
                 fileName, this->portName);
+      pAxis->acquireMoveSocket();
       status = TCLScriptExecute(pAxis->moveSocket_,
                                 fileName,"0","0");
+      pAxis->releaseMoveSocket();
       if (status != 0) {
         asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR, 
                   "TCLScriptExecute returned error %d, on XPS: %s\n", 
@@ -384,6 +425,7 @@ asynStatus XPSController::processDeferredMovesInGroup(char *groupName)
   }
   
   /* Send the group move command. */
+  pAxis->acquireMoveSocket();
   if (relativeMove) {
     status = GroupMoveRelative(pAxis->moveSocket_,
                                groupName,
@@ -395,6 +437,7 @@ asynStatus XPSController::processDeferredMovesInGroup(char *groupName)
                                NbPositioners,
                                positions);
   }
+  pAxis->releaseMoveSocket();
 
   /* Clear the defer flag for all the axes in this group. */
   /* We need to do this for the XPS, because we cannot do partial group moves. Every axis
@@ -518,18 +561,111 @@ asynStatus XPSController::waitMotors()
 /* Function to initialize profile */ 
 asynStatus XPSController::initializeProfile(size_t maxPoints, const char* ftpUsername, const char* ftpPassword)
 {
+  static const char *functionName = "initializeProfile";
+
+  // buildProfile and readbackProfile run in the profile thread without the lock, so they get
+  // their own socket rather than sharing pollSocket_ with the poller
+  if (profileSocket_ < 0) {
+    profileSocket_ = TCP_ConnectToServer(IPAddress_, IPPort_, XPS_POLL_TIMEOUT);
+    if (profileSocket_ < 0) {
+      printf("%s:%s: error calling TCP_ConnectToServer for profileSocket\n",
+             driverName, functionName);
+    }
+  }
   ftpUsername_ = epicsStrDup(ftpUsername);
   ftpPassword_ = epicsStrDup(ftpPassword);
   asynMotorController::initializeProfile(maxPoints);
+  if (profileBuildPositions_) free(profileBuildPositions_);
+  profileBuildPositions_ = (double *)calloc(numAxes_*maxPoints, sizeof(double));
   return asynSuccess;
 }
 
 
 
-/* Function to build, install and verify trajectory */ 
+/* Appends text to the trajectory in memory, enlarging the buffer if needed.
+ * The buffer is kept for the next build, so rebuilding a profile normally does not allocate memory.
+ * If the allocation fails trajectory_ is set to NULL. */
+void XPSController::appendTrajectory(const char *text)
+{
+  size_t len = strlen(text);
+  char *newTrajectory;
+
+  /* An earlier allocation for this trajectory failed */
+  if (!trajectory_ && (trajectoryLength_ > 0)) return;
+  if (trajectoryLength_ + len + 1 > trajectorySize_) {
+    trajectorySize_ = MAX(2*trajectorySize_, trajectoryLength_ + len + 1);
+    newTrajectory = (char *)realloc(trajectory_, trajectorySize_);
+    if (!newTrajectory) {
+      free(trajectory_);
+      trajectorySize_ = 0;
+      trajectoryLength_ += len;
+    }
+    trajectory_ = newTrajectory;
+  }
+  if (!trajectory_) return;
+  memcpy(trajectory_ + trajectoryLength_, text, len+1);
+  trajectoryLength_ += len;
+}
+
+/* Stores the trajectory in memory in fileName in the trajectory directory on the XPS.
+ * The FTP session is kept open between builds, which saves the connect, login and change
+ * directory for each build.  If the XPS has closed the session, e.g. because it was idle
+ * for too long, this reconnects and tries again. */
+int XPSController::storeTrajectory(char *fileName)
+{
+  int status = 0;
+  int retry;
+  static const char *functionName = "storeTrajectory";
+
+  for (retry=0; retry<2; retry++) {
+    if (!ftpConnected_) {
+      status = ftpConnect(IPAddress_, ftpUsername_, ftpPassword_, &ftpSocket_);
+      if (status) {
+        asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+                  "%s:%s: error calling ftpConnect, status=%d\n",
+                  driverName, functionName, status);
+        return status;
+      }
+      status = ftpChangeDir(ftpSocket_, TRAJECTORY_DIRECTORY);
+      if (status) {
+        asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+                  "%s:%s: error calling ftpChangeDir, status=%d\n",
+                  driverName, functionName, status);
+        ftpDisconnect(ftpSocket_);
+        return status;
+      }
+      ftpConnected_ = true;
+    }
+    status = ftpStoreBuffer(ftpSocket_, fileName, trajectory_, trajectoryLength_);
+    if (status == 0) break;
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW,
+              "%s:%s: error calling ftpStoreBuffer, status=%d, reconnecting\n",
+              driverName, functionName, status);
+    ftpDisconnect(ftpSocket_);
+    ftpConnected_ = false;
+  }
+  return status;
+}
+
+/* Called at IOC exit.  Closes the FTP session kept open by storeTrajectory(). */
+void XPSController::shutdown()
+{
+  asynMotorController::shutdown();
+  lock();
+  if (ftpConnected_) {
+    ftpDisconnect(ftpSocket_);
+    ftpConnected_ = false;
+  }
+  unlock();
+}
+
+/* Function to build, install and verify trajectory.
+ * This is called from the profile thread without the lock, see profileHooksUnlocked().
+ * It holds the lock while it builds the trajectory and releases it while it talks to the controller,
+ * so it works from a copy of the profile positions that writeFloat64Array() cannot change. */ 
 asynStatus XPSController::buildProfile()
 {
-  FILE *trajFile;
+  char element[MAX_TRAJECTORY_ELEMENT_LEN];
   int i, j; 
   int status;
   bool buildOK=true;
@@ -538,7 +674,6 @@ asynStatus XPSController::buildProfile()
   int numElements;
   double trajVel;
   double D0, D1, T0, T1;
-  SOCKET ftpSocket;
   char fileName[MAX_FILENAME_LEN];
   char groupName[MAX_GROUPNAME_LEN];
   char message[MAX_MESSAGE_LEN];
@@ -557,12 +692,14 @@ asynStatus XPSController::buildProfile()
   bool inGroup[XPS_MAX_AXES];
   double time;
   int useAxis[XPS_MAX_AXES];
+  double *positions;
   static const char *functionName = "buildProfile";
   
   asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW,
             "%s:%s: entry\n",
             driverName, functionName);
             
+  lock();
   // Call the base class method which will build the time array if needed
   asynMotorController::buildProfile();
 
@@ -586,19 +723,30 @@ asynStatus XPSController::buildProfile()
   getStringParam(XPSTrajectoryFile_, (int)sizeof(fileName), fileName);
   getStringParam(XPSProfileGroupName_, (int)sizeof(groupName), groupName);
 
+  if ((numPoints < 2) || (numPoints > (int)maxProfilePoints_)) {
+    buildOK = false;
+    status = -1;
+    sprintf(message, "Invalid number of points %d\n", numPoints);
+    goto done;
+  }
+
   /* Zero values since axes may not be used */
   for (j=0; j<numAxes_; j++) {
     preVelocity[j] = 0.;
     postVelocity[j] = 0.;
     getIntegerParam(j, profileUseAxis_, &useAxis[j]);
     inGroup[j] = (strcmp(pAxes_[j]->groupName_, groupName) == 0);
+    memcpy(&profileBuildPositions_[j*maxProfilePoints_], pAxes_[j]->profilePositions_, 
+           numPoints*sizeof(double));
   }
   
   for (j=0; j<numAxes_; j++) {
     if (!useAxis[j] || !inGroup[j]) continue;
-    status = PositionerSGammaParametersGet(pollSocket_, pAxes_[j]->positionerName_, 
+    unlock();
+    status = PositionerSGammaParametersGet(profileSocket_, pAxes_[j]->positionerName_, 
                                            &maxVelocity, &maxAcceleration,
                                            &minJerkTime, &maxJerkTime);
+    lock();
     if (status) {
       buildOK = false;
       sprintf(message, "Error calling positionerSGammaParametersSet, status=%d\n", status);
@@ -609,18 +757,18 @@ asynStatus XPSController::buildProfile()
      * is "correct" but subject to roundoff errors when sending ASCII commands
      * to XPS.  Reduce acceleration 10% to account for this. */
     maxAcceleration *= 0.9;
-    distance = pAxes_[j]->profilePositions_[1] - pAxes_[j]->profilePositions_[0];
+    positions = &profileBuildPositions_[j*maxProfilePoints_];
+    distance = positions[1] - positions[0];
     preVelocity[j] = distance/profileTimes_[0];
     time = fabs(preVelocity[j]) / maxAcceleration;
     preTimeMax = MAX(preTimeMax, time);
-    distance = pAxes_[j]->profilePositions_[numPoints-1] - 
-               pAxes_[j]->profilePositions_[numPoints-2];
+    distance = positions[numPoints-1] - positions[numPoints-2];
     postVelocity[j] = distance/profileTimes_[numPoints-1];
     time = fabs(postVelocity[j]) / maxAcceleration;
     postTimeMax = MAX(postTimeMax, time);
     asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW,
               "%s:%s: axis %d profilePositions[0]=%f, profilePositions[%d]=%f, maxAcceleration=%f, preTimeMax=%f, postTimeMax=%f\n",
-              driverName, functionName, j, pAxes_[j]->profilePositions_[0], numPoints-1, pAxes_[j]->profilePositions_[numPoints-1],
+              driverName, functionName, j, positions[0], numPoints-1, positions[numPoints-1],
               maxAcceleration, preTimeMax, postTimeMax);
   }
     
@@ -635,22 +783,18 @@ asynStatus XPSController::buildProfile()
     pAxes_[j]->profilePostDistance_ =  0.5 * postVelocity[j] * postTimeMax; 
   }
 
-  /* Create the profile file */
-  trajFile =  fopen(fileName, "wb");
-  if (trajFile == 0) {
-    buildOK = false;
-    status = -1;
-    sprintf(message, "Error creating trajectory file %s, error=%s\n", fileName, strerror(errno));
-    goto done;
-  }
+  /* Create the trajectory in memory */
+  trajectoryLength_ = 0;
 
   /* Create the initial acceleration element */
-  fprintf(trajFile,"%f", preTimeMax);
+  sprintf(element, "%f", preTimeMax);
+  appendTrajectory(element);
   for (j=0; j<numAxes_; j++) {
     if (!inGroup[j]) continue;
-    fprintf(trajFile,", %f, %f", pAxes_[j]->profilePreDistance_, preVelocity[j]);
+    sprintf(element, ", %f, %f", pAxes_[j]->profilePreDistance_, preVelocity[j]);
+    appendTrajectory(element);
   }
-  fprintf(trajFile,"\n");
+  appendTrajectory("\n");
  
   /* The number of profile elements in the file is numPoints-1 */
   numElements = numPoints - 1;
@@ -660,14 +804,14 @@ asynStatus XPSController::buildProfile()
       T1 = profileTimes_[i+1];
     else
       T1 = T0;
-    fprintf(trajFile,"%f", profileTimes_[i]);
+    sprintf(element, "%f", profileTimes_[i]);
+    appendTrajectory(element);
     for (j=0; j<numAxes_; j++) {
       if (!inGroup[j]) continue;
-      D0 = pAxes_[j]->profilePositions_[i+1] - 
-           pAxes_[j]->profilePositions_[i];
+      positions = &profileBuildPositions_[j*maxProfilePoints_];
+      D0 = positions[i+1] - positions[i];
       if (i < numElements-1) 
-        D1 = pAxes_[j]->profilePositions_[i+2] - 
-             pAxes_[j]->profilePositions_[i+1];
+        D1 = positions[i+2] - positions[i+1];
       else
         D1 = D0;
       /* Average either side of the point */
@@ -676,50 +820,44 @@ asynStatus XPSController::buildProfile()
         D0 = 0.0;  /* Axis turned off*/
         trajVel = 0.0;
       }
-      fprintf(trajFile,", %f, %f",D0,trajVel);
+      sprintf(element, ", %f, %f",D0,trajVel);
+      appendTrajectory(element);
     }  
-    fprintf(trajFile,"\n");
+    appendTrajectory("\n");
   }
 
   /* Create the final acceleration element. Final velocity must be 0. */
-  fprintf(trajFile,"%f", postTimeMax);
+  sprintf(element, "%f", postTimeMax);
+  appendTrajectory(element);
   for (j=0; j<numAxes_; j++) {
     if (!inGroup[j]) continue;
-    fprintf(trajFile,", %f, %f", pAxes_[j]->profilePostDistance_, 0.);
+    sprintf(element, ", %f, %f", pAxes_[j]->profilePostDistance_, 0.);
+    appendTrajectory(element);
   }
-  fclose (trajFile);
-  
-  /* FTP the trajectory file from the local directory to the XPS */
-  status = ftpConnect(IPAddress_, ftpUsername_, ftpPassword_, &ftpSocket);
-  if (status) {
+  if (!trajectory_) {
     buildOK = false;
-    sprintf(message, "Error calling ftpConnect, status=%d\n", status);
-    goto done;
-  }
-  status = ftpChangeDir(ftpSocket, TRAJECTORY_DIRECTORY);
-  if (status) {
-    buildOK = false;
-    sprintf(message, "Error calling  ftpChangeDir, status=%d\n", status);
-    goto done;
-  }
-  status = ftpStoreFile(ftpSocket, fileName);
-  if (status) {
-    buildOK = false;
-    sprintf(message, "Error calling  ftpStoreFile, status=%d\n", status);
+    status = -1;
+    sprintf(message, "Error allocating memory for trajectory\n");
     goto done;
   }
-  status = ftpDisconnect(ftpSocket);
+  
+  /* FTP the trajectory from memory to the XPS */
+  unlock();
+  status = storeTrajectory(fileName);
+  lock();
   if (status) {
     buildOK = false;
-    sprintf(message, "Error calling  ftpDisconnect, status=%d\n", status);
+    sprintf(message, "Error storing trajectory file %s, status=%d\n", fileName, status);
     goto done;
   }
 
   /* Verify trajectory */
   asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW,
             "%s:%s: calling MultipleAxesPVTVerification(%d, %s, %s)\n",
-            driverName, functionName, pollSocket_, groupName, fileName);
-  status = MultipleAxesPVTVerification(pollSocket_, groupName, fileName);
+            driverName, functionName, profileSocket_, groupName, fileName);
+  unlock();
+  status = MultipleAxesPVTVerification(profileSocket_, groupName, fileName);
+  lock();
   if (status) verifyOK = false;
   switch (-status) {
     case 0:
@@ -748,10 +886,12 @@ asynStatus XPSController::buildProfile()
     if (!inGroup[j]) continue;
     maxVelocityActual = 0;
     maxAccelerationActual = 0;   
-    status = MultipleAxesPVTVerificationResultGet(pollSocket_,
+    unlock();
+    status = MultipleAxesPVTVerificationResultGet(profileSocket_,
                  pAxes_[j]->positionerName_, fileName, 
                  &minPositionActual, &maxPositionActual, 
                  &maxVelocityActual, &maxAccelerationActual);
+    lock();
     pAxes_[j]->setDoubleParam(XPSProfileMinPosition_,     minPositionActual);
     pAxes_[j]->setDoubleParam(XPSProfileMaxPosition_,     maxPositionActual);
     pAxes_[j]->setDoubleParam(XPSProfileMaxVelocity_,     maxVelocityActual);
@@ -767,18 +907,21 @@ asynStatus XPSController::buildProfile()
     /* Check that the trajectory won't exceed the software limits
      * The XPS does not check this because the trajectory is defined in relative moves and it does
      * not know where we will be in absolute coordinates when we execute the trajectory */
-    status = PositionerUserTravelLimitsGet(pollSocket_,
+    unlock();
+    status = PositionerUserTravelLimitsGet(profileSocket_,
                                            pAxes_[j]->positionerName_,
                                            &lowLimit, 
                                            &highLimit);
-    minProfile = pAxes_[j]->profilePositions_[0] + minPositionActual;
+    lock();
+    positions = &profileBuildPositions_[j*maxProfilePoints_];
+    minProfile = positions[0] + minPositionActual;
     if (minProfile < lowLimit) {
       verifyOK = false;
       sprintf(message, "Low soft limit violation for axis %s, position=%f, limit=%f\n",
               pAxes_[j]->positionerName_, minProfile, lowLimit);
       goto done;
     }
-    maxProfile = pAxes_[j]->profilePositions_[0] + maxPositionActual;
+    maxProfile = positions[0] + maxPositionActual;
     if (maxProfile > highLimit) {
       verifyOK = false;
       sprintf(message, "High soft limit violation for axis %s, position=%f, limit=%f\n",
@@ -799,9 +942,17 @@ asynStatus XPSController::buildProfile()
   setIntegerParam(profileBuild_, 0);
   setIntegerParam(profileBuildState_, PROFILE_BUILD_DONE);
   callParamCallbacks();
+  unlock();
   return status ? asynError : asynSuccess; 
 }
 
+/* The profile thread calls buildProfile() and readbackProfile() without the lock,
+ * because they block while the trajectory is stored and the gathering data is read */
+bool XPSController::profileHooksUnlocked()
+{
+  return true;
+}
+
 /* Function to execute trajectory */ 
 asynStatus XPSController::executeProfile()
 {
@@ -817,6 +968,21 @@ static void XPSProfileThreadC(void *pPvt)
 }
 
 
+/* Wakes up the poller, and the move watcher threads if they are enabled, because a move has started */
+asynStatus XPSController::wakeupPoller()
+{
+  int i;
+  XPSAxis *pAxis;
+
+  if (moveWatcher_) {
+    for (i=0; i<numAxes_; i++) {
+      pAxis = getAxis(i);
+      if (pAxis && pAxis->moveWatchEvent_) epicsEventSignal(pAxis->moveWatchEvent_);
+    }
+  }
+  return asynMotorController::wakeupPoller();
+}
+
 /* Function which runs in its own thread to execute profiles */ 
 void XPSController::profileThread()
 {
@@ -877,6 +1043,7 @@ asynStatus XPSController::runProfile()
   for (j=0; j<numAxes_; j++) {
     if (!useAxis[j] || !inGroup[j]) continue;
     pAxis = getAxis(j);
+    pAxis->acquireMoveSocket();
     if (moveMode == PROFILE_MOVE_MODE_ABSOLUTE) {
       position = pAxis->profilePositions_[0] - pAxis->profilePreDistance_;
       status = GroupMoveAbsolute(pAxis->moveSocket_,
@@ -890,6 +1057,7 @@ asynStatus XPSController::runProfile()
                                  1,
                                  &position);
     }
+    pAxis->releaseMoveSocket();
   }
 
   // Wait for the motors to get there
@@ -1079,6 +1247,7 @@ asynStatus XPSController::runProfile()
   for (j=0; j<numAxes_; j++) {
     if (!useAxis[j] ||!inGroup[j]) continue;
     pAxis = getAxis(j);
+    pAxis->acquireMoveSocket();
     if (moveMode == PROFILE_MOVE_MODE_ABSOLUTE) {
       position = pAxis->profilePositions_[numPoints-1];
       status = GroupMoveAbsolute(pAxis->moveSocket_,
@@ -1092,6 +1261,7 @@ asynStatus XPSController::runProfile()
                                  1,
                                  &position); 
     }  
+    pAxis->releaseMoveSocket();
   }
   
   // Wait for the motors to get there
@@ -1141,6 +1311,200 @@ asynStatus XPSController::poll()
 
 
 
+/** Polls all of the axes.
+  * If enablePipelinedPoll() has been called then the status commands for every axis are
+  * written back to back on the poll socket, and the replies are split up and passed to each
+  * axis, so a poll cycle costs a single network round trip.  The group status string (on a cache
+  * miss) and the travel limits (when stale) are requested in a second pipelined request.
+  * Otherwise this calls the base class method, which calls XPSAxis::poll() for each axis. */
+asynStatus XPSController::pollAll(asynMotorAxis **pAxes, int numAxes, bool *moving)
+{
+  XPSAxis *pAxis;
+  int i, n;
+  int numCommands=0, numReplies;
+  int m;
+  int numStatusCommands=0, numStatusReplies=0;
+  char **statusReplies;
+  asynStatus status=asynSuccess;
+  static const char *functionName = "pollAll";
+
+  if (!pipelinedPoll_) return asynMotorController::pollAll(pAxes, numAxes, moving);
+
+  pollCommands_[0] = 0;
+  for (i=0; i<numAxes; i++) {
+    moving[i] = false;
+    pAxis = (XPSAxis *)pAxes[i];
+    if (!pAxis) continue;
+    n = pAxis->appendPollCommands(pollCommands_, XPS_POLL_BUFFER_SIZE);
+    if (n < 0) {
+      asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+                "%s:%s: command buffer too small for pipelined poll, polling each axis\n",
+                driverName, functionName);
+      return asynMotorController::pollAll(pAxes, numAxes, moving);
+    }
+    numCommands += n;
+  }
+  if (numCommands == 0) return asynSuccess;
+
+  numReplies = SendAndReceiveMultiple(pollSocket_, pollCommands_, pollReplies_, XPS_POLL_BUFFER_SIZE,
+                                      numCommands, pollReplyPtrs_);
+  if (numReplies != numCommands) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s: error in pipelined poll, sent %d commands, received %d replies\n",
+              driverName, functionName, numCommands, numReplies);
+    for (i=0; i<numAxes; i++) {
+      pAxis = (XPSAxis *)pAxes[i];
+      if (!pAxis) continue;
+      moving[i] = pAxis->moving_;
+      pAxis->setIntegerParam(motorStatusCommsError_, 1);
+      pAxis->callParamCallbacks();
+    }
+    return asynError;
+  }
+
+  /* Request the status string for the axes whose status code is not in the cache, and the
+   * travel limits for the axes whose limits are stale.
+   * These replies go in the second half of the reply buffer. */
+  pollCommands_[0] = 0;
+  for (i=0, n=0; i<numAxes; i++) {
+    pAxis = (XPSAxis *)pAxes[i];
+    if (!pAxis) continue;
+    numStatusCommands += pAxis->appendStatusCommands(pollCommands_, XPS_POLL_BUFFER_SIZE, pollReplyPtrs_[n]);
+    n += XPS_POLL_COMMANDS;
+  }
+  statusReplies = pollReplyPtrs_ + numCommands;
+  if (numStatusCommands > 0) {
+    numStatusReplies = SendAndReceiveMultiple(pollSocket_, pollCommands_, 
+                                              pollReplies_ + XPS_POLL_BUFFER_SIZE, XPS_POLL_BUFFER_SIZE,
+                                              numStatusCommands, statusReplies);
+    if (numStatusReplies != numStatusCommands) {
+      asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+                "%s:%s: error in pipelined poll, sent %d status commands, received %d replies\n",
+                driverName, functionName, numStatusCommands, numStatusReplies);
+      statusReplies = NULL;
+    }
+  }
+
+  for (i=0, n=0, m=0; i<numAxes; i++) {
+    pAxis = (XPSAxis *)pAxes[i];
+    if (!pAxis) continue;
+    if (pAxis->pollReplies(&pollReplyPtrs_[n], statusReplies ? &statusReplies[m] : NULL, 
+                           &moving[i]) != asynSuccess) status = asynError;
+    n += XPS_POLL_COMMANDS;
+    m += (pAxis->readStatusString_ ? 1 : 0) + (pAxis->readLimits_ ? 1 : 0);
+  }
+  return status;
+}
+
+/** Parses the reply to GroupStatusGetString, which is of the form "0,Status string".
+  * \param[in] reply The reply from the controller, with the ",EndOfAPI" terminator removed.
+  * \param[out] statusString The status string.
+  * \param[in] maxChars The size of statusString.
+  * Returns the XPS error code, 0 on success. */
+int XPSController::parseStatusStringReply(const char *reply, char *statusString, size_t maxChars)
+{
+  int status;
+  const char *pStart;
+  char *pEnd;
+
+  status = atoi(reply);
+  if (status) return status;
+  pStart = strchr(reply, ',');
+  if (!pStart) return -1;
+  strncpy(statusString, pStart+1, maxChars-1);
+  statusString[maxChars-1] = 0;
+  pEnd = strchr(statusString, ',');
+  if (pEnd) *pEnd = 0;
+  return 0;
+}
+
+/** Returns the cached status string for a group status code, or NULL if it is not cached.
+  * Updates the status string cache hit and miss counters. */
+const char *XPSController::findStatusString(int statusCode)
+{
+  if ((statusCode >= 0) && (statusCode < XPS_MAX_STATUS_CODES) && statusStrings_[statusCode]) {
+    statusStringHits_++;
+    return statusStrings_[statusCode];
+  }
+  statusStringMisses_++;
+  return NULL;
+}
+
+/** Stores the status string for a group status code in the cache.
+  * Returns a pointer to the cached string, which remains valid for the life of the controller. */
+const char *XPSController::cacheStatusString(int statusCode, const char *statusString)
+{
+  if ((statusCode < 0) || (statusCode >= XPS_MAX_STATUS_CODES)) {
+    strncpy(statusString_, statusString, sizeof(statusString_)-1);
+    statusString_[sizeof(statusString_)-1] = 0;
+    return statusString_;
+  }
+  if (!statusStrings_[statusCode]) statusStrings_[statusCode] = epicsStrDup(statusString);
+  return statusStrings_[statusCode];
+}
+
+/** Returns the status string for a group status code.
+  * The string is taken from the cache, and only read from the controller on a cache miss.
+  * \param[in] statusCode The group status code.
+  * \param[out] statusString Pointer to the status string.
+  * Returns the XPS error code, 0 on success. */
+int XPSController::getStatusString(int statusCode, const char **statusString)
+{
+  char buffer[MAX_MESSAGE_LEN] = {0};
+  int status;
+
+  *statusString = findStatusString(statusCode);
+  if (*statusString) return 0;
+  status = GroupStatusStringGet(pollSocket_, statusCode, buffer);
+  if (status) return status;
+  *statusString = cacheStatusString(statusCode, buffer);
+  return 0;
+}
+
+/** Builds the status string cache.
+  * The strings for all status codes are read from the controller in a single pipelined request.
+  * Codes that the controller does not know are read on demand by getStatusString(). */
+void XPSController::initStatusStrings()
+{
+  char *commands, *replyBuffer;
+  char *replies[XPS_MAX_STATUS_CODES];
+  char statusString[MAX_MESSAGE_LEN];
+  int i, numReplies;
+  static const char *functionName = "initStatusStrings";
+
+  commands    = (char *)calloc(XPS_POLL_BUFFER_SIZE, sizeof(char));
+  replyBuffer = (char *)calloc(XPS_STATUS_STRINGS_BUFFER_SIZE, sizeof(char));
+  for (i=0; i<XPS_MAX_STATUS_CODES; i++) {
+    sprintf(commands + strlen(commands), "GroupStatusStringGet (%d,char *)", i);
+  }
+  numReplies = SendAndReceiveMultiple(pollSocket_, commands, replyBuffer, XPS_STATUS_STRINGS_BUFFER_SIZE,
+                                      XPS_MAX_STATUS_CODES, replies);
+  for (i=0; i<numReplies; i++) {
+    if (parseStatusStringReply(replies[i], statusString, sizeof(statusString)) == 0) {
+      cacheStatusString(i, statusString);
+    }
+  }
+  if (numReplies != XPS_MAX_STATUS_CODES) {
+    asynPrint(pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s:%s: read %d of %d status strings, the rest will be read on demand\n",
+              driverName, functionName, numReplies, XPS_MAX_STATUS_CODES);
+  }
+  free(commands);
+  free(replyBuffer);
+}
+
+/* Function to set the interval at which the poller re-reads the travel limits when the
+   group state has not changed. 0 means read them on every poll. */
+asynStatus XPSController::setLimitsRefreshPeriod(double period)
+{
+  lock();
+  limitsRefreshPeriod_ = period;
+  unlock();
+  return asynSuccess;
+}
+
+
+
 asynStatus XPSController::abortProfile()
 {
   int status;
@@ -1161,26 +1525,106 @@ asynStatus XPSController::abortProfile()
 
 
 /* Function to readback trajectory */ 
+/* Parses a number in the gathering data.  This is much faster than sscanf for the large
+ * number of values in a long profile, and does not depend on the locale.
+ * Numbers with up to 15 significant digits and exponents up to 22 are converted exactly,
+ * others are passed to epicsStrtod.
+ * Returns a pointer to the character after the number, or NULL if there is no number. */
+static const char *parseGatheringValue(const char *ptr, double *value)
+{
+  static const double powersOf10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11, 
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char *p = ptr;
+  const char *start;
+  char *end;
+  double mantissa = 0.;
+  bool negative = false;
+  int digits = 0;
+  int exponent = 0;
+  int expValue = 0;
+  bool expNegative = false;
+
+  if (*p == '-') {
+    negative = true;
+    p++;
+  } else if (*p == '+') {
+    p++;
+  }
+  start = p;
+  while ((*p >= '0') && (*p <= '9')) {
+    if ((digits > 0) || (*p != '0')) digits++;
+    mantissa = mantissa*10. + (*p++ - '0');
+  }
+  if (*p == '.') {
+    p++;
+    while ((*p >= '0') && (*p <= '9')) {
+      if ((digits > 0) || (*p != '0')) digits++;
+      mantissa = mantissa*10. + (*p++ - '0');
+      exponent--;
+    }
+  }
+  if ((p == start) || ((p == start+1) && (*start == '.'))) return NULL;
+  if ((*p == 'e') || (*p == 'E')) {
+    p++;
+    if (*p == '-') {
+      expNegative = true;
+      p++;
+    } else if (*p == '+') {
+      p++;
+    }
+    if ((*p < '0') || (*p > '9')) return NULL;
+    while ((*p >= '0') && (*p <= '9') && (expValue < 10000)) expValue = expValue*10 + (*p++ - '0');
+    exponent += expNegative ? -expValue : expValue;
+  }
+  if ((digits > 15) || (exponent > 22) || (exponent < -22)) {
+    *value = epicsStrtod(ptr, &end);
+    return (end == ptr) ? NULL : end;
+  }
+  if (exponent >= 0) mantissa *= powersOf10[exponent];
+  else               mantissa /= powersOf10[-exponent];
+  *value = negative ? -mantissa : mantissa;
+  return p;
+}
+
+/* Sends the request for numLines lines of gathering data starting at line firstLine.
+ * The reply is read later with ReceiveXPSReplies. */
+int XPSController::requestGatheringLines(int firstLine, int numLines)
+{
+  char command[MAX_MESSAGE_LEN];
+
+  sprintf(command, "GatheringDataMultipleLinesGet (%d,%d,char *)", firstLine, numLines);
+  return SendXPSCommands(profileSocket_, command);
+}
+
+/* Reads the gathering data after a profile has executed.
+ * The data are read in pieces of as many lines as the controller will return in one reply.
+ * If the controller rejects a request the number of lines is halved, and the smaller number
+ * is remembered for later readbacks.  The request for each piece is sent 
+ * before the previous piece is parsed, so reading and parsing overlap.
+ * This is called from the profile thread without the lock.  The gathering data are read on 
+ * profileSocket_, with the lock released, so the poller keeps running during a long readback. */
 asynStatus XPSController::readbackProfile()
 {
   char message[MAX_MESSAGE_LEN];
   bool readbackOK=true;
   int numPulses;
   char* buffer=NULL;
-  char* bptr, *tptr;
+  char* reply;
+  const char* bptr;
   int currentSamples, maxSamples;
   double setpointPosition, actualPosition;
   int readbackStatus;
   int status;
   int i, j;
-  int nitems;
-  int numRead=0, numInBuffer, numChars;
+  int numRead=0, numInBuffer, numRequested;
+  bool pending=false;
   static const char *functionName = "readbackProfile";
     
   asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW,
             "%s:%s: entry\n",
             driverName, functionName);
 
+  lock();
   strcpy(message, "");
   setStringParam(profileReadbackMessage_, message);
   setIntegerParam(profileReadbackState_, PROFILE_READBACK_BUSY);
@@ -1188,6 +1632,7 @@ asynStatus XPSController::readbackProfile()
   callParamCallbacks();
   
   status = getIntegerParam(profileNumPulses_, &numPulses);
+  unlock();
 
   /* Erase the readback and error arrays */
   for (j=0; j<numAxes_; j++) {
@@ -1195,7 +1640,7 @@ asynStatus XPSController::readbackProfile()
     memset(pAxes_[j]->profileFollowingErrors_, 0, maxProfilePoints_*sizeof(double));
   }
   /* Read the number of lines of gathering */
-  status = GatheringCurrentNumberGet(pollSocket_, &currentSamples, &maxSamples);
+  status = GatheringCurrentNumberGet(profileSocket_, &currentSamples, &maxSamples);
   asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW, 
             "%s:%s: GatheringCurrentNumberGet, status=%d, currentSamples=%d, maxSamples=%d\n", 
             driverName, functionName, status, currentSamples, maxSamples);
@@ -1213,50 +1658,76 @@ asynStatus XPSController::readbackProfile()
       currentSamples = maxProfilePoints_;
   }
   buffer = (char *)calloc(GATHERING_MAX_READ_LEN, sizeof(char));
-  numInBuffer = 0;
-  for (numRead=0; numRead<currentSamples;) {
-    /* Read the next buffer */
-    /* Try to read all the remaining points */
-    status = -1;
-    numInBuffer = currentSamples - numRead;
-    while (status && (numInBuffer > 0)) {
-      status = GatheringDataMultipleLinesGet(pollSocket_, numRead, numInBuffer, buffer);
-      asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW, 
-                "%s:%s: GatheringDataMultipleLinesGet, status=%d, numInBuffer=%d\n", 
-                driverName, functionName, status, numInBuffer);
-      if (status) numInBuffer /= 2;
-    }
-    if (numInBuffer == 0) {
+  /* Start with the number of lines the controller accepted in previous reads */
+  numRequested = currentSamples;
+  if ((gatheringLinesPerRead_ > 0) && (gatheringLinesPerRead_ < numRequested)) numRequested = gatheringLinesPerRead_;
+  if (numRequested > 0) {
+    requestGatheringLines(numRead, numRequested);
+    pending = true;
+  }
+  while (numRead < currentSamples) {
+    status = ReceiveXPSReplies(profileSocket_, buffer, GATHERING_MAX_READ_LEN, 1, &reply);
+    pending = false;
+    if (status != 1) {
       readbackOK = false;
-      sprintf(message, "Error reading gathering data, numInBuffer = 0");
+      sprintf(message, "Error reading gathering data, status=%d", status);
       goto done;
     }
-    bptr = buffer;
+    status = atoi(reply);
+    asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW, 
+              "%s:%s: GatheringDataMultipleLinesGet, status=%d, numRequested=%d\n", 
+              driverName, functionName, status, numRequested);
+    if (status) {
+      /* Too many lines for one reply, try half as many */
+      numRequested /= 2;
+      gatheringLinesPerRead_ = numRequested;
+      if (numRequested == 0) {
+        readbackOK = false;
+        sprintf(message, "Error reading gathering data, numInBuffer = 0");
+        goto done;
+      }
+      requestGatheringLines(numRead, numRequested);
+      pending = true;
+      continue;
+    }
+    numInBuffer = numRequested;
+    /* Request the next lines before parsing these ones, so the controller is 
+     * sending the next reply while we parse this one. */
+    if (numRead + numInBuffer < currentSamples) {
+      numRequested = MIN(numInBuffer, currentSamples - numRead - numInBuffer);
+      requestGatheringLines(numRead + numInBuffer, numRequested);
+      pending = true;
+    }
+    /* The data start after the error code */
+    bptr = strchr(reply, ',');
+    if (bptr) bptr++;
     for (i=0; i<numInBuffer; i++) {
-      /* Find the next \n and replace with null */
-      tptr = strstr(bptr, "\n");
-      if (tptr) *tptr = 0;
       for (j=0; j<numAxes_; j++) {
-        nitems = sscanf(bptr, "%lf;%lf%n", 
-                        &setpointPosition, &actualPosition, &numChars);
-        bptr += numChars+1;
-        if (nitems != NUM_GATHERING_ITEMS) {
+        if (bptr) bptr = parseGatheringValue(bptr, &setpointPosition);
+        if (bptr && (*bptr == ';')) bptr = parseGatheringValue(bptr+1, &actualPosition);
+        else bptr = NULL;
+        if (!bptr) {
           readbackOK = false;
-          sprintf(message, "Error reading Gathering.dat file, nitems=%d, should be %d",
-                  nitems, NUM_GATHERING_ITEMS);
+          sprintf(message, "Error parsing gathering data, line=%d, axis=%d", numRead, j);
           goto done;
         }
+        if (*bptr == ';') bptr++;
         // Note, these positions are in controller units, need to be converted to user units
         pAxes_[j]->profileFollowingErrors_[numRead] = actualPosition - setpointPosition;
         pAxes_[j]->profileReadbacks_[numRead] = actualPosition;
       }
+      /* Skip to the start of the next line */
+      bptr = strchr(bptr, '\n');
+      if (bptr) bptr++;
       numRead++;
-      bptr = tptr + 1;
     }
   }
   
   done:
+  /* Read the reply to an outstanding request so it is not mistaken for the reply to the next command */
+  if (pending) ReceiveXPSReplies(profileSocket_, buffer, GATHERING_MAX_READ_LEN, 1, &reply);
   if (buffer) free(buffer);
+  lock();
   setIntegerParam(profileActualPulses_, numRead);
   setIntegerParam(profileNumReadbacks_, numRead);
   /* Convert from controller to user units and post the arrays */
@@ -1275,6 +1746,7 @@ asynStatus XPSController::readbackProfile()
   setIntegerParam(profileReadback_, 0);
   setIntegerParam(profileReadbackState_, PROFILE_READBACK_DONE);
   callParamCallbacks();
+  unlock();
   return status ? asynError : asynSuccess; 
 }
 
@@ -1305,6 +1777,50 @@ asynStatus XPSController::enableMovingMode()
   return asynSuccess; 
 }
 
+/* Function to enable a mode where the poller writes the status commands for all axes
+   back to back on the poll socket and then reads all of the replies, rather than waiting
+   for each reply before sending the next command. This reduces the cost of a poll cycle
+   to about one network round trip, rather than 6 per axis. */ 
+asynStatus XPSController::enablePipelinedPoll()
+{
+  lock();
+  if (!pollCommands_) {
+    pollCommands_  = (char *)calloc(XPS_POLL_BUFFER_SIZE, sizeof(char));
+    pollReplies_   = (char *)calloc(2*XPS_POLL_BUFFER_SIZE, sizeof(char));
+    pollReplyPtrs_ = (char **)calloc(numAxes_*(XPS_POLL_COMMANDS+2), sizeof(char *));
+  }
+  pipelinedPoll_ = true;
+  unlock();
+  return asynSuccess; 
+}
+
+
+
+/* Function to start a thread for each axis which waits on the moveSocket of the axis while
+   it is moving, and wakes up the poller as soon as the move complete reply arrives. This bounds
+   the time to detect the end of a move by the network rather than the moving poll period.
+   timeout is the timeout of each blocking read, which is also the longest time a command
+   on the moveSocket of a moving axis can wait for the thread to give up the socket; stops are
+   sent on the pollSocket, so they do not wait.  See XPSAxis::moveWatchThread().
+   The moveSocket reply is only used to determine motion done in moving mode, so this also
+   enables that mode; see XPSController::enableMovingMode(). 
+   Axes created later start their own thread. */ 
+asynStatus XPSController::enableMoveWatcher(double timeout)
+{
+  int i;
+  XPSAxis *pAxis;
+
+  lock();
+  enableMovingMode_ = true;
+  moveWatchTimeout_ = (timeout > 0.) ? timeout : XPS_DEFAULT_MOVE_WATCH_TIMEOUT;
+  moveWatcher_ = true;
+  for (i=0; i<numAxes_; i++) {
+    pAxis = getAxis(i);
+    if (pAxis) pAxis->startMoveWatcher();
+  }
+  unlock();
+  return asynSuccess; 
+}
 
 
 /** The following functions have C linkage, and can be called directly or from iocsh */
@@ -1417,6 +1933,48 @@ asynStatus XPSEnableMovingMode(const char *XPSName)
   return pC->enableMovingMode();
 }
 
+asynStatus XPSEnableMoveWatcher(const char *XPSName, double timeout)
+{
+  XPSController *pC;
+  static const char *functionName = "XPSEnableMoveWatcher";
+
+  pC = (XPSController*) findAsynPortDriver(XPSName);
+  if (!pC) {
+    printf("%s:%s: Error port %s not found\n", driverName, functionName, XPSName);
+    return asynError;
+  }
+
+  return pC->enableMoveWatcher(timeout);
+}
+
+asynStatus XPSSetLimitsRefreshPeriod(const char *XPSName, double period)
+{
+  XPSController *pC;
+  static const char *functionName = "XPSSetLimitsRefreshPeriod";
+
+  pC = (XPSController*) findAsynPortDriver(XPSName);
+  if (!pC) {
+    printf("%s:%s: Error port %s not found\n", driverName, functionName, XPSName);
+    return asynError;
+  }
+
+  return pC->setLimitsRefreshPeriod(period);
+}
+
+asynStatus XPSEnablePipelinedPoll(const char *XPSName)
+{
+  XPSController *pC;
+  static const char *functionName = "XPSEnablePipelinedPoll";
+
+  pC = (XPSController*) findAsynPortDriver(XPSName);
+  if (!pC) {
+    printf("%s:%s: Error port %s not found\n", driverName, functionName, XPSName);
+    return asynError;
+  }
+
+  return pC->enablePipelinedPoll();
+}
+
 
 
 
@@ -1514,6 +2072,40 @@ static void enableMovingModeCallFunc(const iocshArgBuf *args)
   XPSEnableMovingMode(args[0].sval);
 }
 
+/* XPSEnablePipelinedPoll */
+static const iocshArg XPSEnablePipelinedPollArg0 = {"Controller port name", iocshArgString};
+static const iocshArg * const XPSEnablePipelinedPollArgs[] = {&XPSEnablePipelinedPollArg0};
+static const iocshFuncDef enablePipelinedPoll = {"XPSEnablePipelinedPoll", 1, XPSEnablePipelinedPollArgs};
+
+static void enablePipelinedPollCallFunc(const iocshArgBuf *args)
+{
+  XPSEnablePipelinedPoll(args[0].sval);
+}
+
+/* XPSEnableMoveWatcher */
+static const iocshArg XPSEnableMoveWatcherArg0 = {"Controller port name", iocshArgString};
+static const iocshArg XPSEnableMoveWatcherArg1 = {"Read timeout (s)", iocshArgDouble};
+static const iocshArg * const XPSEnableMoveWatcherArgs[] = {&XPSEnableMoveWatcherArg0,
+                                                            &XPSEnableMoveWatcherArg1};
+static const iocshFuncDef enableMoveWatcher = {"XPSEnableMoveWatcher", 2, XPSEnableMoveWatcherArgs};
+
+static void enableMoveWatcherCallFunc(const iocshArgBuf *args)
+{
+  XPSEnableMoveWatcher(args[0].sval, args[1].dval);
+}
+
+/* XPSSetLimitsRefreshPeriod */
+static const iocshArg XPSSetLimitsRefreshPeriodArg0 = {"Controller port name", iocshArgString};
+static const iocshArg XPSSetLimitsRefreshPeriodArg1 = {"Refresh period (s)", iocshArgDouble};
+static const iocshArg * const XPSSetLimitsRefreshPeriodArgs[] = {&XPSSetLimitsRefreshPeriodArg0,
+                                                                 &XPSSetLimitsRefreshPeriodArg1};
+static const iocshFuncDef setLimitsRefreshPeriod = {"XPSSetLimitsRefreshPeriod", 2, XPSSetLimitsRefreshPeriodArgs};
+
+static void setLimitsRefreshPeriodCallFunc(const iocshArgBuf *args)
+{
+  XPSSetLimitsRefreshPeriod(args[0].sval, args[1].dval);
+}
+
 
 static void XPSRegister3(void)
 {
@@ -1523,6 +2115,9 @@ static void XPSRegister3(void)
   iocshRegister(&disableAutoEnable,    disableAutoEnableCallFunc);
   iocshRegister(&noDisableError,       noDisableErrorCallFunc);
   iocshRegister(&enableMovingMode,     enableMovingModeCallFunc);
+  iocshRegister(&enablePipelinedPoll,  enablePipelinedPollCallFunc);
+  iocshRegister(&enableMoveWatcher,    enableMoveWatcherCallFunc);
+  iocshRegister(&setLimitsRefreshPeriod, setLimitsRefreshPeriodCallFunc);
 }
 epicsExportRegistrar(XPSRegister3);
 
@@ -6,6 +6,8 @@ USAGE...        Newport XPS EPICS asyn motor device driver
 #ifndef XPSController_H
 #define XPSController_H
 
+#include <osiSock.h>
+
 #include "asynMotorController.h"
 #include "asynMotorAxis.h"
 #include "XPSAxis.h"
@@ -14,12 +16,27 @@ USAGE...        Newport XPS EPICS asyn motor device driver
 #define XPS_POLL_TIMEOUT 2.0
 #define XPS_MOVE_TIMEOUT 100000.0 // "Forever"
 #define XPS_MIN_PROFILE_ACCEL_TIME 0.25
+/* Size of the command and reply buffers used for pipelined polling */
+#define XPS_POLL_BUFFER_SIZE 16384
+/* Number of group status codes whose status strings are cached */
+#define XPS_MAX_STATUS_CODES 128
+#define XPS_STATUS_STRINGS_BUFFER_SIZE 65536
+/* Default time between reads of the travel limits when the group state does not change */
+#define XPS_DEFAULT_LIMITS_REFRESH_PERIOD 5.0
+/* Default timeout of the blocking reads of the move sockets by the move watcher threads.
+ * A command on the move socket of a moving axis can wait up to this long. */
+#define XPS_DEFAULT_MOVE_WATCH_TIMEOUT 1.0
+/* Time a move watcher thread waits for a move to start when its axis is not moving */
+#define XPS_MOVE_WATCH_IDLE_TIMEOUT 1.0
 
 /* Constants used for FTP to the XPS */
 #define TRAJECTORY_DIRECTORY "/Admin/Public/Trajectories"
 #define MAX_FILENAME_LEN  256
 #define MAX_MESSAGE_LEN   256
 #define MAX_GROUPNAME_LEN  64
+/* Maximum length of one time or "distance, velocity" element in a trajectory.
+ * "%f" of the largest double is about 320 characters. */
+#define MAX_TRAJECTORY_ELEMENT_LEN 1024
 
 #define MAX_PULSE_WIDTHS 4
 #define MAX_SETTLING_TIMES 4
@@ -66,6 +83,7 @@ class epicsShareClass XPSController : public asynMotorController {
   XPSAxis* getAxis(asynUser *pasynUser);
   XPSAxis* getAxis(int axisNo);
   asynStatus poll();
+  asynStatus pollAll(asynMotorAxis **pAxes, int numAxes, bool *moving);
   asynStatus setDeferredMoves(bool deferMoves);
 
   /* These are the functions for profile moves */
@@ -74,6 +92,8 @@ class epicsShareClass XPSController : public asynMotorController {
   asynStatus executeProfile();
   asynStatus abortProfile();
   asynStatus readbackProfile();
+  bool profileHooksUnlocked();
+  void shutdown();
 
   /* These are the methods that are new to this class */
   void profileThread();
@@ -92,6 +112,22 @@ class epicsShareClass XPSController : public asynMotorController {
    to determine motion done. */ 
   asynStatus enableMovingMode();
 
+  /* Function to enable a mode where the poller sends the status commands for all axes
+   in a single pipelined request. */
+  asynStatus enablePipelinedPoll();
+
+  /* Function to start a thread for each axis that waits on its moveSocket for the
+   end of move reply and wakes up the poller when it arrives. */
+  asynStatus enableMoveWatcher(double timeout);
+  asynStatus wakeupPoller();
+
+  /* Functions for the cache of status strings and travel limits */
+  asynStatus setLimitsRefreshPeriod(double period);
+  int getStatusString(int statusCode, const char **statusString);
+  const char *findStatusString(int statusCode);
+  const char *cacheStatusString(int statusCode, const char *statusString);
+  static int parseStatusStringReply(const char *reply, char *statusString, size_t maxChars);
+
 
   protected:
   XPSAxis **pAxes_;       /**< Array of pointers to axis objects */
@@ -126,12 +162,37 @@ class epicsShareClass XPSController : public asynMotorController {
   char *ftpPassword_;
   int pollSocket_;
   int moveSocket_;
+  int profileSocket_;            /**< Used by buildProfile and readbackProfile, which run without the lock */
   char firmwareVersion_[100];
   bool movesDeferred_;
   epicsEventId profileExecuteEvent_;
   int autoEnable_;
   int noDisableError_;
   bool enableMovingMode_;
+  bool pipelinedPoll_;
+  char *pollCommands_;
+  char *pollReplies_;
+  char **pollReplyPtrs_;
+  char *statusStrings_[XPS_MAX_STATUS_CODES];  /**< Cache of status strings, indexed by status code */
+  char statusString_[MAX_MESSAGE_LEN];         /**< Status string for codes outside the cache */
+  unsigned long statusStringHits_;
+  unsigned long statusStringMisses_;
+  unsigned long limitsHits_;
+  unsigned long limitsMisses_;
+  double limitsRefreshPeriod_;
+  bool moveWatcher_;
+  double moveWatchTimeout_;
+  double *profileBuildPositions_; /**< Copy of the axes' profile positions that buildProfile() works from */
+  char *trajectory_;             /**< The trajectory built by buildProfile() */
+  size_t trajectorySize_;        /**< Allocated size of trajectory_ */
+  size_t trajectoryLength_;      /**< Length of the trajectory in trajectory_ */
+  SOCKET ftpSocket_;             /**< FTP session used to store trajectories */
+  bool ftpConnected_;            /**< ftpSocket_ is connected and in the trajectory directory */
+  void appendTrajectory(const char *text);
+  int storeTrajectory(char *fileName);
+  int gatheringLinesPerRead_;   /**< Maximum lines of gathering data the controller has accepted in one read, 0=unknown */
+  int requestGatheringLines(int firstLine, int numLines);
+  void initStatusStrings();
   
   friend class XPSAxis;
 };
@@ -250,6 +250,7 @@ int ReadXPSSocket (int SocketIndex, char valueRtrn[], int returnSize, double tim
         return -1;
     }
 
+    epicsMutexMustLock(psock->mutexId);
     /* Loop until we the response contains ",EndOfAPI" or we get an error */
     do {
         status = pasynOctetSyncIO->read(psock->pasynUser,
@@ -264,10 +265,214 @@ int ReadXPSSocket (int SocketIndex, char valueRtrn[], int returnSize, double tim
         nread += nbytesIn;
     } while ((status==asynSuccess) && 
              (strcmp(valueRtrn + nread - strlen(XPS_TERMINATOR), XPS_TERMINATOR) != 0));
+    epicsMutexUnlock(psock->mutexId);
     return (int)nread;
 }
 
+
+/***************************************************************************************/
+/* Locks the socket, so that a thread can read from it or send several commands on it
+ * without another thread using it in between.  SendAndReceive and ReadXPSSocket also lock
+ * the socket; the lock is recursive, so they can be called while it is held. */
+void LockXPSSocket (int SocketIndex)
+{
+    if ((SocketIndex < 0) || (SocketIndex >= nextSocket)) {
+        printf("LockXPSSocket: invalid SocketIndex %d\n", SocketIndex);
+        return;
+    }
+    epicsMutexMustLock(socketStructs[SocketIndex].mutexId);
+}
+
+
+/***************************************************************************************/
+void UnlockXPSSocket (int SocketIndex)
+{
+    if ((SocketIndex < 0) || (SocketIndex >= nextSocket)) {
+        printf("UnlockXPSSocket: invalid SocketIndex %d\n", SocketIndex);
+        return;
+    }
+    epicsMutexUnlock(socketStructs[SocketIndex].mutexId);
+}
+
 
+/***************************************************************************************/
+/* Reads from the socket until the buffer contains numReplies ",EndOfAPI" terminators.
+ * nread bytes have already been read into valueRtrn, and status is the status of that read.
+ * Must be called with psock->mutexId locked.  See SendAndReceiveMultiple for the arguments. */
+static int ReadReplies (socketStruct *psock, int status, size_t nread, char valueRtrn[], int returnSize,
+                        int numReplies, char *replies[])
+{
+    size_t nbytesIn;
+    int eomReason;
+    size_t termLen = strlen(XPS_TERMINATOR);
+    int numFound;
+    char *pStart, *pEnd;
+
+    /* Loop until we have numReplies terminators, an error, or a full buffer */
+    valueRtrn[nread] = 0;
+    numFound = 0;
+    pStart = valueRtrn;
+    while (1) {
+        while ((numFound < numReplies) && ((pEnd = strstr(pStart, XPS_TERMINATOR)) != NULL)) {
+            replies[numFound++] = pStart;
+            pStart = pEnd + termLen;
+        }
+        if ((numFound == numReplies) || (status != asynSuccess) || (nread >= (size_t)returnSize-1)) break;
+        status = pasynOctetSyncIO->read(psock->pasynUser,
+                                        &valueRtrn[nread],
+                                        returnSize-1-nread,
+                                        psock->timeout,
+                                        &nbytesIn,
+                                        &eomReason);
+        if (status != asynSuccess) {
+            asynPrint(psock->pasynUser, ASYN_TRACE_ERROR,
+                      "ReadReplies error calling read, status=%d, error=%s\n",
+                      status, psock->pasynUser->errorMessage);
+        }
+        nread += nbytesIn;
+        valueRtrn[nread] = 0;
+        asynPrint(psock->pasynUser, ASYN_TRACEIO_DRIVER,
+                  "ReadReplies, received: nread=%d, numFound=%d, nbytesIn=%d\n",
+                  (int)nread, numFound, (int)nbytesIn);
+    }
+
+    /* Terminate each reply at the start of its ",EndOfAPI" */
+    for (int i=0; i<numFound; i++) {
+        pEnd = strstr(replies[i], XPS_TERMINATOR);
+        if (pEnd) *pEnd = 0;
+    }
+    if (numFound < numReplies) {
+        asynPrint(psock->pasynUser, ASYN_TRACE_ERROR,
+                  "ReadReplies, expected %d replies, received %d\n",
+                  numReplies, numFound);
+        return (status != asynSuccess) ? -1 : numFound;
+    }
+    return numFound;
+}
+
+
+/***************************************************************************************/
+/* Sends a buffer containing several XPS API commands back to back and reads the replies.
+ * The XPS answers each command in order with a string terminated by ",EndOfAPI", so this
+ * function keeps reading until numReplies terminators have been received.  On return
+ * replies[i] points to the i'th reply within valueRtrn, with the ",EndOfAPI" terminator removed.
+ * This allows a poll cycle to cost a single network round trip rather than one per command.
+ * Returns the number of complete replies received, or -1 on error. */
+int SendAndReceiveMultiple (int SocketIndex, char buffer[], char valueRtrn[], int returnSize,
+                            int numReplies, char *replies[])
+{
+    size_t nbytesOut; 
+    size_t nbytesIn;
+    int eomReason;
+    socketStruct *psock;
+    int status;
+    int numFound;
+
+    if ((SocketIndex < 0) || (SocketIndex >= nextSocket)) {
+        printf("SendAndReceiveMultiple: invalid SocketIndex %d\n", SocketIndex);
+        return -1;
+    }
+    psock = &socketStructs[SocketIndex];
+    if (!psock->connected) {
+        printf("SendAndReceiveMultiple: socket not connected %d\n", SocketIndex);
+        return -1;
+    }
+    if ((numReplies <= 0) || (returnSize <= 1)) return 0;
+
+    epicsMutexMustLock(psock->mutexId);
+    /* Leave room for a terminating nil so we can search the replies with strstr */
+    status = pasynOctetSyncIO->writeRead(psock->pasynUser,
+                                         (char const *)buffer, 
+                                         strlen(buffer),
+                                         valueRtrn,
+                                         returnSize-1,
+                                         psock->timeout,
+                                         &nbytesOut,
+                                         &nbytesIn,
+                                         &eomReason);
+    if (status != asynSuccess) {
+        asynPrint(psock->pasynUser, ASYN_TRACE_ERROR,
+                  "SendAndReceiveMultiple error calling writeRead, output=%s status=%d, error=%s\n",
+                  buffer, status, psock->pasynUser->errorMessage);
+        nbytesIn = 0;
+    }
+    valueRtrn[nbytesIn] = 0;
+    asynPrint(psock->pasynUser, ASYN_TRACEIO_DRIVER,
+              "SendAndReceiveMultiple, sent: '%s', received: '%s'\n",
+              buffer, valueRtrn);
+    numFound = ReadReplies(psock, status, nbytesIn, valueRtrn, returnSize, numReplies, replies);
+    epicsMutexUnlock(psock->mutexId);
+    return numFound;
+}
+
+
+/***************************************************************************************/
+/* Sends one or more XPS API commands without waiting for the replies, which must later be
+ * read with ReceiveXPSReplies.  This lets the caller do other work while the XPS is
+ * executing the commands and sending the replies.  The caller must prevent other commands
+ * being sent on this socket until the replies have been read.
+ * Returns 0 on success or -1 on error. */
+int SendXPSCommands (int SocketIndex, char buffer[])
+{
+    size_t nbytesOut; 
+    socketStruct *psock;
+    int status;
+
+    if ((SocketIndex < 0) || (SocketIndex >= nextSocket)) {
+        printf("SendXPSCommands: invalid SocketIndex %d\n", SocketIndex);
+        return -1;
+    }
+    psock = &socketStructs[SocketIndex];
+    if (!psock->connected) {
+        printf("SendXPSCommands: socket not connected %d\n", SocketIndex);
+        return -1;
+    }
+
+    epicsMutexMustLock(psock->mutexId);
+    status = pasynOctetSyncIO->write(psock->pasynUser,
+                                     (char const *)buffer, 
+                                     strlen(buffer),
+                                     psock->timeout,
+                                     &nbytesOut);
+    epicsMutexUnlock(psock->mutexId);
+    if (status != asynSuccess) {
+        asynPrint(psock->pasynUser, ASYN_TRACE_ERROR,
+                  "SendXPSCommands error calling write, output=%s status=%d, error=%s\n",
+                  buffer, status, psock->pasynUser->errorMessage);
+        return -1;
+    }
+    asynPrint(psock->pasynUser, ASYN_TRACEIO_DRIVER,
+              "SendXPSCommands, sent: '%s'\n", buffer);
+    return 0;
+}
+
+
+/***************************************************************************************/
+/* Reads the replies to commands sent with SendXPSCommands.  The arguments and return value
+ * are the same as for SendAndReceiveMultiple. */
+int ReceiveXPSReplies (int SocketIndex, char valueRtrn[], int returnSize, int numReplies, char *replies[])
+{
+    socketStruct *psock;
+    int numFound;
+
+    if ((SocketIndex < 0) || (SocketIndex >= nextSocket)) {
+        printf("ReceiveXPSReplies: invalid SocketIndex %d\n", SocketIndex);
+        return -1;
+    }
+    psock = &socketStructs[SocketIndex];
+    if (!psock->connected) {
+        printf("ReceiveXPSReplies: socket not connected %d\n", SocketIndex);
+        return -1;
+    }
+    if ((numReplies <= 0) || (returnSize <= 1)) return 0;
+
+    epicsMutexMustLock(psock->mutexId);
+    numFound = ReadReplies(psock, asynSuccess, 0, valueRtrn, returnSize, numReplies, replies);
+    epicsMutexUnlock(psock->mutexId);
+    return numFound;
+}
+
+
 /***************************************************************************************/
 void CloseSocket(int SocketIndex)
 {
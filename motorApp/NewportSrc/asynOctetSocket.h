@@ -1 +1,7 @@
 int ReadXPSSocket (int SocketIndex, char valueRtrn[], int returnSize, double timeout);
+void LockXPSSocket (int SocketIndex);
+void UnlockXPSSocket (int SocketIndex);
+int SendAndReceiveMultiple (int SocketIndex, char buffer[], char valueRtrn[], int returnSize,
+                            int numReplies, char *replies[]);
+int SendXPSCommands (int SocketIndex, char buffer[]);
+int ReceiveXPSReplies (int SocketIndex, char valueRtrn[], int returnSize, int numReplies, char *replies[]);
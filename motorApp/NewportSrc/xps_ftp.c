@@ -24,6 +24,9 @@
 static int code(char*);
 static int sendFtpCommandAndReceive (SOCKET, char*, char*);
 static int getPort (SOCKET, char*);
+static SOCKET openStore (SOCKET, char*);
+static int sendData (SOCKET, const char*, size_t);
+static int closeStore (SOCKET, SOCKET);
 #ifdef DEBUG
 static void printRecv (char*, int);
 #endif
@@ -112,6 +115,8 @@ epicsShareFunc int ftpRetrieveFile(SOCKET socketFD, char *filename)
   memset(&adr_rcv, 0, sizeof(adr_rcv));
      
   port_rcv = getPort(socketFD, ip); 
+  if (port_rcv < 0)
+    return -1;
   
   socketFDReceive = socket (AF_INET, SOCK_STREAM, 0);
   
@@ -175,17 +180,85 @@ epicsShareFunc int ftpRetrieveFile(SOCKET socketFD, char *filename)
 /******[ ftpStoreFile ]**********************************************/
 epicsShareFunc int ftpStoreFile(SOCKET socketFD, char *filename)
 {
-  int port_snd, i;
+  int i, status = 0;
+  SOCKET socketFDSend;
+  char buffer[RETURN_SIZE];
+  FILE *file;
+
+  /* open file on localhost */
+  if (NULL == (file = fopen(filename, "rb")))
+    {
+      fprintf(stderr,"Cound not open file \"%s\" for reading on local host\n", filename);
+      return -1;
+    }
+
+  socketFDSend = openStore(socketFD, filename);
+  if (socketFDSend == INVALID_SOCKET)
+    {
+      fclose(file);
+      return -1;
+    }
+
+  do
+    {
+      i = (int)fread(buffer, sizeof(char), RETURN_SIZE, file);
+      if (sendData(socketFDSend, buffer, i) < 0)
+        {
+          status = -1;
+          break;
+        }
+    }
+  while(i != 0);
+
+  fclose(file);
+
+  if (closeStore(socketFD, socketFDSend) < 0)
+    status = -1;
+
+  return status;
+}
+
+
+/******[ ftpStoreBuffer ]********************************************/
+/* Stores length bytes from buffer in a file on the server, without a local file.
+ * The control connection is left open so the caller can store more files in the same session.
+ * Returns -1 if the transfer fails, e.g. because the server closed the session. */
+epicsShareFunc int ftpStoreBuffer(SOCKET socketFD, char *filename, const char *buffer, size_t length)
+{
+  int status = 0;
+  SOCKET socketFDSend;
+
+  socketFDSend = openStore(socketFD, filename);
+  if (socketFDSend == INVALID_SOCKET)
+    return -1;
+
+  if (sendData(socketFDSend, buffer, length) < 0)
+    status = -1;
+
+  if (closeStore(socketFD, socketFDSend) < 0)
+    status = -1;
+
+  return status;
+}
+
+
+/******[ openStore ]*************************************************/
+/* Opens the passive data connection and sends "STOR filename".
+ * Returns the data socket, or INVALID_SOCKET if the server refuses or has closed the session. */
+static SOCKET openStore(SOCKET socketFD, char *filename)
+{
+  int port_snd;
   SOCKET socketFDSend;
   struct sockaddr_in adr_snd;
   char ip[IP_SIZE];
   char command[COMMAND_SIZE];
   char returnString[RETURN_SIZE];
-  FILE *file;
 
   memset(&adr_snd, 0, sizeof(adr_snd));
      
   port_snd = getPort(socketFD, ip); 
+  if (port_snd < 0)
+    return INVALID_SOCKET;
   
   socketFDSend = socket (AF_INET, SOCK_STREAM, 0);
   
@@ -199,45 +272,64 @@ epicsShareFunc int ftpStoreFile(SOCKET socketFD, char *filename)
 
   if (0 > connect (socketFDSend, (struct sockaddr *) &adr_snd, sizeof(adr_snd)))
     { 
-      fprintf(stderr,"Cound not connect to FTP server to retrieve file %s\n", filename);
-      return -1;
-      
+      fprintf(stderr,"Could not connect to FTP server to store file %s\n", filename);
+      ftpDisconnect(socketFDSend);
+      return INVALID_SOCKET;
     }
   
   /* send command */
   sprintf(command, "STOR %s", filename);
-  if (-1 == sendFtpCommandAndReceive (socketFD, command, returnString))
-    return -1;
-
-  /* open file on localhost */
-  if (NULL == (file = fopen(filename, "rb")))
+  if ((-1 == sendFtpCommandAndReceive (socketFD, command, returnString)) ||
+      (code(returnString) >= 400))
     {
-      fprintf(stderr,"Cound not open file \"%s\" for reading on local host\n", filename);
-      return -1;
+      ftpDisconnect(socketFDSend);
+      return INVALID_SOCKET;
     }
 
-  do
+  return socketFDSend;
+}
+
+
+/******[ sendData ]**************************************************/
+/* Sends length bytes on the data connection.  Returns -1 if they could not all be sent. */
+static int sendData(SOCKET socketFDSend, const char *buffer, size_t length)
+{
+  int i;
+  size_t nsent;
+
+  for (nsent = 0; nsent < length; nsent += i)
     {
-	  i = (int)fread(returnString, sizeof(char), RETURN_SIZE, file);
-      send(socketFDSend,returnString, i, 0);
+      i = send(socketFDSend, buffer + nsent, (int)(length - nsent), 0);
+      if (i <= 0)
+        return -1;
     }
-  while(i != 0);
-   
-#ifdef _WIN32
-  closesocket(socketFDSend);
-#else
-  close(socketFDSend);
-#endif
+  return 0;
+}
 
-  fclose(file);
 
-  i = recv(socketFD, returnString, RETURN_SIZE, 0);     /* read "226 Transfer complete." */
+/******[ closeStore ]************************************************/
+/* Closes the data connection opened by openStore() and reads the transfer reply.
+ * Returns -1 if the server reports an error or has closed the session. */
+static int closeStore(SOCKET socketFD, SOCKET socketFDSend)
+{
+  int i;
+  char returnString[RETURN_SIZE];
+
+  ftpDisconnect(socketFDSend);
+
+  i = recv(socketFD, returnString, RETURN_SIZE-1, 0);     /* read "226 Transfer complete." */
+  if (i <= 0)
+    return -1;
+  returnString[i] = '\0';
 
 #ifdef DEBUG
   printf(" -> ");
   printRecv(returnString, i);
 #endif
 
+  if (code(returnString) >= 400)
+    return -1;
+
   return 0;
 }
 
@@ -245,8 +337,9 @@ epicsShareFunc int ftpStoreFile(SOCKET socketFD, char *filename)
 /******[ code ]******************************************************/
 static int code (char *str)
 {
-  char tmp[3];
+  char tmp[4];
   strncpy(tmp, str, 3);
+  tmp[3] = '\0';
   return atoi(tmp);
 }
 
@@ -264,7 +357,9 @@ static int sendFtpCommandAndReceive (SOCKET socketFD, char* command, char* retur
 	sprintf(command, "%s\n", command);
 
 	send (socketFD, command, (int)strlen(command), 0);
-	receivedBytes = recv(socketFD, str_rec, RETURN_SIZE, 0);
+	receivedBytes = recv(socketFD, str_rec, RETURN_SIZE-1, 0);
+	if (receivedBytes <= 0)       /* The server has closed the connection */
+		return -1;
    
 #ifdef DEBUG
 	printf(" -> ");
@@ -313,7 +408,9 @@ static int sendFtpCommandAndReceive (SOCKET socketFD, char* command, char* retur
 			}
 
 			if ((j+4) >= strlen(str_rec)) {       /* Last line not found yet, keep going */
-				i = recv(socketFD, str_rec, RETURN_SIZE, 0);
+				i = recv(socketFD, str_rec, RETURN_SIZE-1, 0);
+				if (i <= 0)
+					return -1;
 				str_rec[i] = '\0';
 			}
 		}
@@ -331,7 +428,9 @@ static int  getPort (SOCKET socketFD, char* ip)
   int count, i, j, port;
 
   strcpy(command, "PASV");
-  sendFtpCommandAndReceive (socketFD, command, returnString);
+  if ((-1 == sendFtpCommandAndReceive (socketFD, command, returnString)) ||
+      (code(returnString) != 227))
+    return -1;
   
   i = 27;
   count = 0;
@@ -47,6 +47,7 @@ epicsShareFunc int ftpDisconnect (SOCKET);
 epicsShareFunc int ftpChangeDir (SOCKET, char*);
 epicsShareFunc int ftpRetrieveFile (SOCKET, char*);
 epicsShareFunc int ftpStoreFile(SOCKET, char*);
+epicsShareFunc int ftpStoreBuffer(SOCKET, char*, const char*, size_t);
 
 #ifdef __cplusplus
 }
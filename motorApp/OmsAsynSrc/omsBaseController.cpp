@@ -81,6 +81,8 @@ omsBaseController::omsBaseController(const char *portName, int maxAxes, int prio
     numAxes = maxAxes;
     controllerType = NULL;
     baseMutex = new epicsMutex;
+    combinedQueryDivisor = 0;
+    slowPollCounter = 0;
 
     if (prio == 0)
         priority = epicsThreadPriorityLow;
@@ -121,10 +123,26 @@ asynStatus omsBaseController::startPoller(double movingPollPeriod, double idlePo
 }
 
 
+/*
+ * Enable the combined poll query if slowPollDivisor > 0.
+ * Limits and closed loop status are read every slowPollDivisor poll cycles.
+ */
+asynStatus omsBaseController::setCombinedQuery(int slowPollDivisor)
+{
+    if ((slowPollDivisor > 0) && !canCombineQueries()) {
+        errlogPrintf("omsBaseController:setCombinedQuery: %s controller %s doesn't support combined queries\n",
+                controllerType, portName);
+        return asynError;
+    }
+    lock();
+    combinedQueryDivisor = (slowPollDivisor > 0) ? slowPollDivisor : 0;
+    slowPollCounter = 0;
+    unlock();
+    return asynSuccess;
+}
+
 void omsBaseController::shutdown(){
-      lock();
-      shuttingDown_ = 1;
-      unlock();
+      asynMotorController::shutdown();
 }
 
 void omsBaseController::report(FILE *fp, int level)
@@ -135,6 +153,8 @@ void omsBaseController::report(FILE *fp, int level)
 
     fprintf(fp, "Oms %s motor driver %s, numAxes=%d; Firmware: %d.%d.%d\n",
         controllerType, portName, numAxes, fwMajor, fwMinor, fwRevision);
+    if (combinedQueryDivisor > 0)
+        fprintf(fp, "  combined poll query, limits read every %d polls\n", combinedQueryDivisor);
 
     for (axis=0; axis < numAxes; axis++) {
         omsBaseAxis *pAxis = pAxes[axis];
@@ -599,6 +619,8 @@ void omsBaseController::omsPoller()
     unsigned int limitFlags;
     epicsTimeStamp now, loopStart;
     bool haveCLStatus, haveVeloArray, haveEncStatus, haveLimits, useEncoder=false, moveDone;
+    bool slowPoll=false, haveCombined;
+    int divisor;
 
     lock();
     movingPollPeriod = movingPollPeriod_;
@@ -628,73 +650,90 @@ void omsBaseController::omsPoller()
 
         epicsTimeGetCurrent(&loopStart);
 
-        /* read all axis status values and reset done-field
-         * MDNN,MDNN,PNLN,PNNN,PNLN,PNNN,PNNN,PNNN */
-        retry_count = 0;
-        while ((getAxesStatus(statusBuffer, sizeof(statusBuffer), &moveDone) != asynSuccess) && (retry_count < 5)){
-            Debug(1, "%s:%s:%s: error reading axes status\n", driverName, functionName, this->portName);
-            epicsThreadSleep(0.1);
-            ++retry_count;
+        lock();
+        divisor = combinedQueryDivisor;
+        if (divisor > 0) {
+            slowPoll = (slowPollCounter == 0);
+            if (++slowPollCounter >= divisor) slowPollCounter = 0;
         }
+        unlock();
 
-        if (retry_count > 4){
-            errlogPrintf("%s:%s:%s: error reading axis status (%d attempts)\n",
-                    driverName, functionName, this->portName, retry_count);
-            ++loopBreakCount;
-            resetConnection();
-            continue;
-        }
+        haveCombined = (divisor > 0) &&
+            (getCombinedStatus(slowPoll, useEncoder, anyMoving, statusBuffer, sizeof(statusBuffer), &moveDone,
+                    axisPosArr, encPosArr, veloArr, &haveVeloArray, encStatusBuffer, sizeof(encStatusBuffer),
+                    &haveEncStatus, closedLoopStatus, &haveCLStatus, &limitFlags, &haveLimits) == asynSuccess);
+        if (haveCombined) loopBreakCount = 0;
+
+        /* fall back to single queries if the combined query is disabled or failed */
+        if (!haveCombined) {
+            /* read all axis status values and reset done-field
+             * MDNN,MDNN,PNLN,PNNN,PNLN,PNNN,PNNN,PNNN */
+            retry_count = 0;
+            while ((getAxesStatus(statusBuffer, sizeof(statusBuffer), &moveDone) != asynSuccess) && (retry_count < 5)){
+                Debug(1, "%s:%s:%s: error reading axes status\n", driverName, functionName, this->portName);
+                epicsThreadSleep(0.1);
+                ++retry_count;
+            }
 
-        if (getAxesPositions(axisPosArr) != asynSuccess){
-            Debug(1, "%s:%s:%s: error reading axis positions\n", driverName, functionName, this->portName);
-            ++loopBreakCount;
-            continue;
-        }
+            if (retry_count > 4){
+                errlogPrintf("%s:%s:%s: error reading axis status (%d attempts)\n",
+                        driverName, functionName, this->portName, retry_count);
+                ++loopBreakCount;
+                resetConnection();
+                continue;
+            }
 
-        if (useEncoder && (getEncoderPositions(encPosArr) != asynSuccess)){
-            Debug(1, "%s:%s:%s: error reading encoder positions\n", driverName, functionName, this->portName);
-            ++loopBreakCount;
-            continue;
-        }
-        loopBreakCount = 0;
+            if (getAxesPositions(axisPosArr) != asynSuccess){
+                Debug(1, "%s:%s:%s: error reading axis positions\n", driverName, functionName, this->portName);
+                ++loopBreakCount;
+                continue;
+            }
+
+            if (useEncoder && (getEncoderPositions(encPosArr) != asynSuccess)){
+                Debug(1, "%s:%s:%s: error reading encoder positions\n", driverName, functionName, this->portName);
+                ++loopBreakCount;
+                continue;
+            }
+            loopBreakCount = 0;
 /*
-        if (sanityCheck() != asynSuccess){
-            errlogPrintf("%s:%s:%s: error during sanity check\n", driverName, functionName, this->portName);
-        }
+            if (sanityCheck() != asynSuccess){
+                errlogPrintf("%s:%s:%s: error during sanity check\n", driverName, functionName, this->portName);
+            }
 */
 
-        if (anyMoving)
-            haveCLStatus = false;
-        else
-            haveCLStatus = true;
-        if (haveCLStatus && getClosedLoopStatus(closedLoopStatus) != asynSuccess){
-            haveCLStatus = false;
-            Debug(1, "%s:%s:%s: error executing get Closed Loop Status\n", driverName, functionName, this->portName);
-        }
+            if (anyMoving)
+                haveCLStatus = false;
+            else
+                haveCLStatus = true;
+            if (haveCLStatus && getClosedLoopStatus(closedLoopStatus) != asynSuccess){
+                haveCLStatus = false;
+                Debug(1, "%s:%s:%s: error executing get Closed Loop Status\n", driverName, functionName, this->portName);
+            }
 
-        haveVeloArray = true;
-        if (getAxesArray((char*) "AM;RV;", veloArr) != asynSuccess){
-            haveVeloArray = false;
-            Debug(1,"%s:%s:%s: Error executing command Report Velocity (RV)\n", driverName, functionName, this->portName);
-        }
-        haveEncStatus = true;
-        if (sendReceiveLock((char*) "AM;EA;", encStatusBuffer, sizeof(encStatusBuffer)) != asynSuccess){
-            haveEncStatus = false;
-            Debug(1,"%s:%s:%s: Error reading encoder status buffer >%s<\n", driverName, functionName, this->portName, encStatusBuffer);
-        }
+            haveVeloArray = true;
+            if (getAxesArray((char*) "AM;RV;", veloArr) != asynSuccess){
+                haveVeloArray = false;
+                Debug(1,"%s:%s:%s: Error executing command Report Velocity (RV)\n", driverName, functionName, this->portName);
+            }
+            haveEncStatus = true;
+            if (sendReceiveLock((char*) "AM;EA;", encStatusBuffer, sizeof(encStatusBuffer)) != asynSuccess){
+                haveEncStatus = false;
+                Debug(1,"%s:%s:%s: Error reading encoder status buffer >%s<\n", driverName, functionName, this->portName, encStatusBuffer);
+            }
 
-        haveLimits = true;
-        limitFlags =0;
-		if ((sendReceiveLock((char*) "AM;QL;", pollInputBuffer, sizeof(pollInputBuffer)) == asynSuccess)){
-			if (1 != sscanf(pollInputBuffer, "%x", &limitFlags)){
-				Debug(1,"%s:%s:%s: error converting limits: %s\n", driverName, functionName, this->portName, pollInputBuffer);
-				haveLimits = false;
-			}
-		}
-		else {
-			haveLimits = false;
-			Debug(1,"%s:%s:%s: error reading limits %s\n", driverName, functionName, this->portName, pollInputBuffer);
-		}
+            haveLimits = true;
+            limitFlags =0;
+            if ((sendReceiveLock((char*) "AM;QL;", pollInputBuffer, sizeof(pollInputBuffer)) == asynSuccess)){
+                if (1 != sscanf(pollInputBuffer, "%x", &limitFlags)){
+                    Debug(1,"%s:%s:%s: error converting limits: %s\n", driverName, functionName, this->portName, pollInputBuffer);
+                    haveLimits = false;
+                }
+            }
+            else {
+                haveLimits = false;
+                Debug(1,"%s:%s:%s: error reading limits %s\n", driverName, functionName, this->portName, pollInputBuffer);
+            }
+        }
         if (enabled) watchdogOK();
 
         anyMoving = 0;
@@ -851,17 +890,8 @@ asynStatus omsBaseController::getClosedLoopStatus(int clstatus[OMS_MAX_AXES])
     if (firmwareMin(1,30,0)){
         pollInputBuffer[0] = '\0';
         status = sendReceiveLock((char*) "AM;CL?;", pollInputBuffer, sizeof(pollInputBuffer));
-        if (status == asynSuccess) {
-            for (int i=0; i < numAxes; ++i) {
-                status = getSubstring(i, pollInputBuffer, clBuffer, sizeof(clBuffer));
-                if ( status == asynSuccess){
-                    if (strncmp(clBuffer, "on", 2))
-                        clstatus[i] = 1;
-                    else
-                        clstatus[i] = 0;
-                }
-            }
-        }
+        if (status == asynSuccess)
+            status = parseClosedLoopStatus(pollInputBuffer, clstatus);
     }
     else {
         for (int i=0; i < numAxes; ++i) {
@@ -882,6 +912,110 @@ asynStatus omsBaseController::getClosedLoopStatus(int clstatus[OMS_MAX_AXES])
     return status;
 }
 
+/*
+ * Read the poller data with one concatenated query instead of one transaction per item.
+ * Limits and closed loop status change slowly and are only requested if slowPoll is set,
+ * the closed loop status only if no axis is moving (as in the single query mode).
+ * The transport returns the replies in order, separated by newlines.
+ */
+asynStatus omsBaseController::getCombinedStatus(bool slowPoll, bool useEncoder, bool anyMoving,
+        char *statusBuff, unsigned int statusSize, bool *done, epicsInt32 *axisPosArr,
+        epicsInt32 *encPosArr, epicsInt32 *veloArr, bool *haveVeloArray,
+        char *encStatusBuff, unsigned int encStatusSize, bool *haveEncStatus,
+        int *clstatus, bool *haveCLStatus, unsigned int *limitFlags, bool *haveLimits)
+{
+    char outputBuff[40];
+    char *replies[OMS_COMBINED_MAX_REPLIES];
+    char *p;
+    int numReplies = 3, reply = 0;
+    bool readCL = slowPoll && !anyMoving && firmwareMin(1,30,0);
+    asynStatus status;
+
+    strcpy(outputBuff, "AM;RI;PP;");
+    if (useEncoder) {
+        strcat(outputBuff, "PE;");
+        ++numReplies;
+    }
+    strcat(outputBuff, "RV;EA;");
+    ++numReplies;
+    if (slowPoll) {
+        strcat(outputBuff, "QL;");
+        ++numReplies;
+    }
+    if (readCL) {
+        strcat(outputBuff, "CL?;");
+        ++numReplies;
+    }
+
+    baseMutex->lock();
+    status = sendReceiveMulti(outputBuff, combinedInputBuffer, sizeof(combinedInputBuffer), numReplies);
+    baseMutex->unlock();
+    if (status != asynSuccess) {
+        Debug(1, "%s:getCombinedStatus:%s: error reading combined status (%s)\n", driverName, portName, outputBuff);
+        return status;
+    }
+
+    /* split the replies */
+    for (p = combinedInputBuffer; (p != NULL) && (reply < numReplies); ++reply) {
+        replies[reply] = p;
+        p = strchr(p, '\n');
+        if (p != NULL) *p++ = '\0';
+    }
+    if (reply < numReplies) {
+        Debug(1, "%s:getCombinedStatus:%s: got %d of %d replies\n", driverName, portName, reply, numReplies);
+        return asynError;
+    }
+
+    reply = 0;
+    *done = false;
+    if (parseAxesStatus(replies[reply++], done) != asynSuccess) return asynError;
+    strncpy(statusBuff, replies[0], statusSize);
+    statusBuff[statusSize-1] = '\0';
+    if (parseAxesArray(replies[reply++], axisPosArr) != asynSuccess) return asynError;
+    if (useEncoder && (parseAxesArray(replies[reply++], encPosArr) != asynSuccess)) return asynError;
+
+    *haveVeloArray = (parseAxesArray(replies[reply++], veloArr) == asynSuccess);
+    strncpy(encStatusBuff, replies[reply++], encStatusSize);
+    encStatusBuff[encStatusSize-1] = '\0';
+    *haveEncStatus = true;
+
+    *haveLimits = false;
+    if (slowPoll) {
+        *limitFlags = 0;
+        if (1 == sscanf(replies[reply], "%x", limitFlags))
+            *haveLimits = true;
+        else
+            Debug(1,"%s:getCombinedStatus:%s: error converting limits: %s\n", driverName, portName, replies[reply]);
+        ++reply;
+    }
+
+    *haveCLStatus = false;
+    if (readCL)
+        *haveCLStatus = (parseClosedLoopStatus(replies[reply++], clstatus) == asynSuccess);
+    else if (slowPoll && !anyMoving)
+        *haveCLStatus = (getClosedLoopStatus(clstatus) == asynSuccess);
+
+    return asynSuccess;
+}
+
+/* convert the reply of "CL?" (firmware 1.30 and above) */
+asynStatus omsBaseController::parseClosedLoopStatus(char *inputBuff, int clstatus[OMS_MAX_AXES])
+{
+    asynStatus status = asynSuccess;
+    char clBuffer[9];
+
+    for (int i=0; i < numAxes; ++i) {
+        status = getSubstring(i, inputBuff, clBuffer, sizeof(clBuffer));
+        if ( status == asynSuccess){
+            if (strncmp(clBuffer, "on", 2))
+                clstatus[i] = 1;
+            else
+                clstatus[i] = 0;
+        }
+    }
+    return status;
+}
+
 asynStatus omsBaseController::sanityCheck()
 {
     const char* functionName="sanityCheck";
@@ -995,15 +1129,23 @@ asynStatus omsBaseController::getAxesStatus(char *inputBuff, int inputSize, bool
 
     status = sendReceiveLock(outputBuff, inputBuff, inputSize);
 
-    if (status == asynSuccess){
-        if (strchr(inputBuff, 'D') != NULL) *done=true;
-        if (!((inputBuff[0] == 'P') || (inputBuff[0] == 'M')))
-            status = asynError;
-        if (strlen(inputBuff) < (unsigned int)(numAxes * 5 -1))
-            status = asynError;
-        if (status == asynError) Debug(1, "%s:getAxesStatus:%s: corrupted status string %s\n",
-                driverName, portName, inputBuff);
-    }
+    if (status == asynSuccess)
+        status = parseAxesStatus(inputBuff, done);
+    return status;
+}
+
+/* check the reply of "RI" and set done if any axis reports the done flag */
+asynStatus omsBaseController::parseAxesStatus(char *inputBuff, bool *done)
+{
+    asynStatus status = asynSuccess;
+
+    if (strchr(inputBuff, 'D') != NULL) *done=true;
+    if (!((inputBuff[0] == 'P') || (inputBuff[0] == 'M')))
+        status = asynError;
+    if (strlen(inputBuff) < (unsigned int)(numAxes * 5 -1))
+        status = asynError;
+    if (status == asynError) Debug(1, "%s:getAxesStatus:%s: corrupted status string %s\n",
+            driverName, portName, inputBuff);
     return status;
 }
 
@@ -1019,17 +1161,26 @@ asynStatus omsBaseController::getAxesArray(char* cmd, int positions[OMS_MAX_AXES
     // we expect numAxes values separated with commas
     // possible answers are "0,5000,0" ",,,," "0" ",,," (3 commas for 4 axes)
 
-    const char* functionName="getAxesArray";
     asynStatus status = asynSuccess;
     char inputBuff[OMSINPUTBUFFERLEN] = "";
+
+    status = sendReceiveLock(cmd, inputBuff, sizeof(inputBuff));
+    if (status == asynSuccess)
+        status = parseAxesArray(inputBuff, positions);
+    return status;
+}
+
+/* convert a comma-separated reply with one value per axis */
+asynStatus omsBaseController::parseAxesArray(char *inputBuff, int positions[OMS_MAX_AXES] )
+{
+    const char* functionName="getAxesArray";
     char *start, *end, *stop;
     int i, intVal, again = 1;
     int count =0;
 
-    status = sendReceiveLock(cmd, inputBuff, sizeof(inputBuff));
-    if ((status == asynSuccess) && (strlen(inputBuff) >= (unsigned int)numAxes -1)) {
+    if (strlen(inputBuff) >= (unsigned int)numAxes -1) {
         start = inputBuff;
-        stop = start + MIN(strlen(inputBuff), sizeof(inputBuff));
+        stop = start + strlen(inputBuff);
         for (i = 0; ((i < OMS_MAX_AXES) && again); ++i){
             if (*start == ','){
                 positions[i] = 0;
@@ -1061,13 +1212,11 @@ asynStatus omsBaseController::getAxesArray(char* cmd, int positions[OMS_MAX_AXES
         }
     }
     else {
-        if (status == asynSuccess){
-            errlogPrintf("%s:%s:%s: read string too short %d\n",
-                                driverName, functionName, portName, (int)strlen(inputBuff));
-            return asynError;
-        }
+        errlogPrintf("%s:%s:%s: read string too short %d\n",
+                            driverName, functionName, portName, (int)strlen(inputBuff));
+        return asynError;
     }
-    return status;
+    return asynSuccess;
 }
 
 asynStatus omsBaseController::getSubstring(unsigned int number, char* inputBuffer, char *outBuffer, unsigned int outBufferLen)
@@ -1126,3 +1275,35 @@ bool omsBaseController::watchdogOK()
     return true;
 }
 
+
+extern "C" int omsSetCombinedQuery(
+              const char *portName,      /* OMS Motor Asyn Port name */
+              int slowPollDivisor)       /* read limits every n polls, 0 disables the combined query */
+{
+    omsBaseController *pController = omsBaseController::findController(portName);
+    if (pController == NULL) {
+        errlogPrintf("omsSetCombinedQuery: unknown asyn port %s\n", portName);
+        return asynError;
+    }
+    return pController->setCombinedQuery(slowPollDivisor);
+}
+
+/* Code for iocsh registration */
+
+/* omsSetCombinedQuery */
+static const iocshArg omsSetCombinedQueryArg0 = {"asyn motor port name", iocshArgString};
+static const iocshArg omsSetCombinedQueryArg1 = {"slow poll divisor", iocshArgInt};
+static const iocshArg * const omsSetCombinedQueryArgs[2] = {&omsSetCombinedQueryArg0,
+                                                      &omsSetCombinedQueryArg1 };
+static const iocshFuncDef setCombinedQueryOms = {"omsSetCombinedQuery", 2, omsSetCombinedQueryArgs};
+static void setCombinedQueryOmsCallFunc(const iocshArgBuf *args)
+{
+    omsSetCombinedQuery(args[0].sval, args[1].ival);
+}
+
+static void OmsBaseAsynRegister(void)
+{
+    iocshRegister(&setCombinedQueryOms, setCombinedQueryOmsCallFunc);
+}
+
+epicsExportRegistrar(OmsBaseAsynRegister);
@@ -26,6 +26,9 @@ USAGE...        Pro-Dex OMS asyn motor base controller support
 #define OMS_MAX_AXES 10
 #define OMSBASE_MAXNUMBERLEN 12
 #define OMSINPUTBUFFERLEN OMSBASE_MAXNUMBERLEN * OMS_MAX_AXES + 2
+/* the combined poll query returns up to 7 replies (RI,PP,PE,RV,EA,QL,CL?) */
+#define OMS_COMBINED_MAX_REPLIES 7
+#define OMSCOMBINEDBUFFERLEN OMSINPUTBUFFERLEN * OMS_COMBINED_MAX_REPLIES
 
 class omsBaseController : public asynMotorController {
 public:
@@ -41,6 +44,8 @@ public:
     static void callPoller(void*);
     static void callShutdown(void *ptr){((omsBaseController*)ptr)->shutdown();};
     void shutdown();
+    asynStatus setCombinedQuery(int slowPollDivisor);
+    static omsBaseController* findController(const char*);
 
 protected:
     virtual asynStatus writeOctet(asynUser *, const char *, size_t, size_t *);
@@ -59,9 +64,10 @@ protected:
     virtual epicsEventWaitStatus waitInterruptible(double timeout);
     virtual bool watchdogOK();
     virtual bool resetConnection(){return false;};
+    virtual bool canCombineQueries(){return false;};
+    virtual asynStatus sendReceiveMulti(const char*, char*, unsigned int, int){return asynError;};
     char* getPortName(){return portName;};
     bool firmwareMin(int, int, int);
-    static omsBaseController* findController(const char*);
     static ELLLIST omsControllerList;
     static int omsTotalControllerNumber;
     char* controllerType;
@@ -76,6 +82,11 @@ private:
     asynStatus sendReplace(omsBaseAxis*, char*);
     asynStatus sendReceiveReplace(omsBaseAxis*, char *, char *, int);
     asynStatus getSubstring(unsigned int , char* , char *, unsigned int);
+    asynStatus parseAxesStatus(char *, bool *);
+    asynStatus parseAxesArray(char *, int positions[OMS_MAX_AXES]);
+    asynStatus parseClosedLoopStatus(char *, int clstatus[OMS_MAX_AXES]);
+    asynStatus getCombinedStatus(bool, bool, bool, char *, unsigned int, bool *, epicsInt32 *, epicsInt32 *,
+            epicsInt32 *, bool *, char *, unsigned int, bool *, int *, bool *, unsigned int *, bool *);
     int sanityCounter;
     epicsThreadId motorThread;
     char inputBuffer[OMSINPUTBUFFERLEN];
@@ -88,6 +99,9 @@ private:
     int receiveIndex;
     int pollIndex;
     int priority, stackSize;
+    int combinedQueryDivisor;
+    int slowPollCounter;
+    char combinedInputBuffer[OMSCOMBINEDBUFFERLEN];
 
     friend class omsBaseAxis;
 };
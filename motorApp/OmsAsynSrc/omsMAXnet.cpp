@@ -299,6 +299,78 @@ asynStatus omsMAXnet::sendReceive(const char *outputBuff, char *inputBuff, unsig
     return status;
 }
 
+/*
+ * send a concatenated query and read numReplies EOS terminated replies
+ * the replies are copied into inputBuff separated by newlines
+ */
+asynStatus omsMAXnet::sendReceiveMulti(const char *outputBuff, char *inputBuff, unsigned int inputSize, int numReplies)
+{
+    char localBuffer[MAXnet_MAX_BUFFERLENGTH + 1] = "";
+    size_t nRead=0, nReadnext=0, nWrite=0, used=0, len;
+    size_t bufferSize = MAXnet_MAX_BUFFERLENGTH;
+    int eomReason = 0, count = 0;
+    bool written = false;
+    asynStatus status;
+    char *outString;
+
+    if (!enabled) return asynError;
+    *inputBuff = '\0';
+
+    /* discard pending notifications, they would be taken as replies */
+    while (notificationCounter > 0) {
+        status = pasynOctetSyncIO->read(pasynUserSyncIOSerial, localBuffer, bufferSize, 0.001, &nRead, &eomReason);
+        if (status != asynSuccess) {
+            notificationCounter = 0;
+            break;
+        }
+        localBuffer[nRead] = '\0';
+        if (isNotification(localBuffer)) --notificationCounter;
+    }
+    status = asynSuccess;
+
+    Debug(4, "omsMAXnet::sendReceiveMulti: write: %s \n", outputBuff);
+
+    while ((status == asynSuccess) && (count < numReplies)) {
+        nRead=0;
+        eomReason = 0;
+        if (!written) {
+            /* writeRead flushes any stale input before the write, like sendReceive */
+            status = pasynOctetSyncIO->writeRead(pasynUserSyncIOSerial, outputBuff, strlen(outputBuff), localBuffer,
+                                                bufferSize, timeout, &nWrite, &nRead, &eomReason);
+            written = true;
+        }
+        while ((status == asynSuccess) && !(eomReason & ASYN_EOM_EOS) && (nRead < bufferSize)) {
+            status = pasynOctetSyncIO->read(pasynUserSyncIOSerial, localBuffer+nRead,
+                                                 bufferSize-nRead, timeout, &nReadnext, &eomReason);
+            nRead += nReadnext;
+        }
+        if (status != asynSuccess) break;
+        localBuffer[nRead] = '\0';
+        // cut off a leading CR, NL, /006
+        outString = localBuffer;
+        while ((*outString == 6)||(*outString == 13)||(*outString == 10)) ++outString;
+        // skip empty lines and notifications
+        if (*outString == '\0') continue;
+        if (isNotification(outString)) {
+            if (notificationCounter > 0) --notificationCounter;
+            continue;
+        }
+        len = strlen(outString);
+        if (used + len + 2 > inputSize) {
+            status = asynOverflow;
+            break;
+        }
+        if (count > 0) inputBuff[used++] = '\n';
+        strcpy(inputBuff + used, outString);
+        used += len;
+        ++count;
+    }
+
+    Debug(4, "omsMAXnet::sendReceiveMulti: read %d of %d replies: %s \n", count, numReplies, inputBuff);
+
+    return status;
+}
+
 /*
  * check if buffer is a notification messages with 13 chars ("%000 SSSSSSSS")
  * (first character may miss
@@ -25,6 +25,8 @@ public:
     asynStatus sendReceive(const char *, char *, unsigned int );
     asynStatus sendOnly(const char *);
     virtual bool resetConnection();
+    virtual bool canCombineQueries(){return true;};
+    virtual asynStatus sendReceiveMulti(const char *, char *, unsigned int, int);
 
 private:
     int isNotification (char *);
@@ -297,6 +297,11 @@ asynStatus PIGCSController::haltAxis(PIasynAxis* pAxis)
  */
 asynStatus PIGCSController::getAxisPosition(PIasynAxis* pAxis, double& position)
 {
+	if (m_bInPollCycle && pAxis->m_bPositionCached)
+	{
+		position = pAxis->m_cachedPosition;
+		return asynSuccess;
+	}
 	char cmd[100];
 	char buf[255];
 	sprintf(cmd, "POS? %s", pAxis->m_szAxisName);
@@ -500,6 +505,11 @@ asynStatus PIGCSController::setServo(PIasynAxis* pAxis, int servoState)
 
 asynStatus PIGCSController::getMoving(PIasynAxis* pAxis, int& moving)
 {
+	if (m_bInPollCycle && m_bMovingStateCached)
+	{
+	    moving = (m_movingState & pAxis->m_movingStateMask) != 0 ? 1 : 0;
+	    return asynSuccess;
+	}
 	char buf[255];
     asynStatus status = m_pInterface->sendAndReceive(char(5), buf, 99);;
     if (status != asynSuccess)
@@ -512,9 +522,104 @@ return status;
     long movingState = strtol(buf, &pStr, 16);
     moving = (movingState & pAxis->m_movingStateMask) != 0 ? 1 : 0;
 
+    // #5 reports all axes - the other axes of this poll cycle use the same reply
+    if (m_bInPollCycle)
+    {
+    	m_movingState = movingState;
+    	m_bMovingStateCached = true;
+    }
+
     return status;
 }
 
+/**
+ *  Start a poll cycle for the axes in \a pAxes.
+ *  Reads the positions of all these axes with a single "POS?" query; until
+ *  endPollCycle() is called getAxisPosition() returns these values and
+ *  controller-wide replies (e.g. to #5) are read only once.
+ *  If the controller rejects the multi-axis query, single axis queries
+ *  are used from then on.
+ */
+asynStatus PIGCSController::beginPollCycle(asynMotorAxis** pAxes, int numAxes)
+{
+	m_bInPollCycle = true;
+	m_bMovingStateCached = false;
+
+	char cmd[1024] = "POS?";
+	int nrAxes = 0;
+	for (int i=0; i<numAxes; i++)
+	{
+		PIasynAxis* pAxis = (PIasynAxis*)pAxes[i];
+		if (pAxis == NULL)
+		{
+			continue;
+		}
+		pAxis->m_bPositionCached = false;
+		if (pAxis->m_szAxisName == NULL || strlen(cmd) + strlen(pAxis->m_szAxisName) + 2 > sizeof(cmd))
+		{
+			continue;
+		}
+		strcat(cmd, " ");
+		strcat(cmd, pAxis->m_szAxisName);
+		nrAxes++;
+	}
+	if (!m_bBatchAxisQueries || !CanBatchAxisQueries() || nrAxes == 0)
+	{
+		return asynSuccess;
+	}
+
+	char buf[4096];
+	asynStatus status = m_pInterface->sendAndReceive(cmd, buf, sizeof(buf)-1);
+	if (status != asynSuccess)
+	{
+		int err = getGCSError();
+		if (err > 0)
+		{
+			m_bBatchAxisQueries = false;
+			if (m_pInterface->m_pCurrentLogSink != NULL)
+			{
+				asynPrint(m_pInterface->m_pCurrentLogSink, ASYN_TRACE_FLOW|ASYN_TRACE_ERROR,
+						"PIGCSController::beginPollCycle() \"%s\" failed, GCS error %d - using single axis queries\n",
+						cmd, err);
+			}
+		}
+		return asynSuccess;
+	}
+
+	// reply is one "<axis>=<position>" line per axis
+	char* pLine = buf;
+	while (pLine != NULL && *pLine != '\0')
+	{
+		char* pNext = strchr(pLine, '\n');
+		if (pNext != NULL)
+		{
+			*pNext++ = '\0';
+		}
+		char* pValue = strchr(pLine, '=');
+		if (pValue != NULL)
+		{
+			*pValue++ = '\0';
+			size_t len = strlen(pLine);
+			while (len > 0 && pLine[len-1] == ' ')
+			{
+				pLine[--len] = '\0';
+			}
+			for (int i=0; i<numAxes; i++)
+			{
+				PIasynAxis* pAxis = (PIasynAxis*)pAxes[i];
+				if (pAxis != NULL && pAxis->m_szAxisName != NULL && strcmp(pAxis->m_szAxisName, pLine) == 0)
+				{
+					pAxis->m_cachedPosition = atof(pValue);
+					pAxis->m_bPositionCached = true;
+					break;
+				}
+			}
+		}
+		pLine = pNext;
+	}
+	return asynSuccess;
+}
+
 asynStatus PIGCSController::getBusy(PIasynAxis* pAxis, int& busy)
 {
 	char buf[255];
@@ -562,6 +667,10 @@ PIGCSController::PIGCSController(PIInterface* pInterface, const char* szIDN)
 , m_bAnyAxisMoving(false)
 , m_nrFoundAxes(0)
 , m_LastError(0)
+, m_bBatchAxisQueries(true)
+, m_bInPollCycle(false)
+, m_bMovingStateCached(false)
+, m_movingState(0)
 {
 	strncpy(szIdentification, szIDN, 199);
 }
@@ -65,6 +65,8 @@ public:
     virtual asynStatus getResolution(PIasynAxis* pAxis, double& resolution );
     virtual asynStatus getStatus(PIasynAxis* pAxis, int& homing, int& moving, int& negLimit, int& posLimit, int& servoControl) = 0;
     virtual asynStatus getGlobalState( asynMotorAxis** Axes, int numAxes ) { return asynSuccess; }
+    virtual asynStatus beginPollCycle( asynMotorAxis** Axes, int numAxes );
+    virtual void endPollCycle() { m_bInPollCycle = false; }
     virtual asynStatus getMoving(PIasynAxis* pAxis, int& homing);
     virtual asynStatus getBusy(PIasynAxis* pAxis, int& busy);
     virtual asynStatus getTravelLimits(PIasynAxis* pAxis, double& negLimit, double& posLimit);
@@ -87,6 +89,7 @@ public:
     size_t getNrFoundAxes() { return m_nrFoundAxes; }
 
     virtual bool IsGCS2() { return true; }
+    virtual bool CanBatchAxisQueries() { return IsGCS2(); }
 
     int getGCSError();
 
@@ -111,6 +114,11 @@ protected:
 	int m_LastError;
 
     bool m_KnowsVELcommand;
+
+    bool m_bBatchAxisQueries;	///< if \b TRUE multi-axis queries are used in beginPollCycle()
+    bool m_bInPollCycle;		///< if \b TRUE replies cached in this poll cycle are valid
+    bool m_bMovingStateCached;	///< if \b TRUE m_movingState holds the reply to #5 of this poll cycle
+    long m_movingState;
 };
 
 #endif /* PIGCSCONTROLLER_H_ */
@@ -133,13 +133,33 @@ asynStatus PIGCSMotorController::getResolution(PIasynAxis* pAxis, double& resolu
 
 }
 
+asynStatus PIGCSMotorController::beginPollCycle(asynMotorAxis** pAxes, int numAxes)
+{
+    m_bStatusCached = false;
+    return PIGCSController::beginPollCycle(pAxes, numAxes);
+}
+
 asynStatus PIGCSMotorController::getStatus(PIasynAxis* pAxis, int& homing, int& moving, int& negLimit, int& posLimit, int& servoControl)
 {
     char buf[255];
-    asynStatus status = m_pInterface->sendAndReceive(char(4), buf, 99);
-    if (status != asynSuccess)
+    asynStatus status = asynSuccess;
+    if (m_bInPollCycle && m_bStatusCached)
     {
-        return status;
+        strcpy(buf, m_szStatus);
+    }
+    else
+    {
+        status = m_pInterface->sendAndReceive(char(4), buf, 99);
+        if (status != asynSuccess)
+        {
+            return status;
+        }
+        // #4 reports all axes - the other axes of this poll cycle use the same reply
+        if (m_bInPollCycle)
+        {
+            strcpy(m_szStatus, buf);
+            m_bStatusCached = true;
+        }
     }
     // TODO this is for a single axis C-863/867 controller!!!!
     // TODO a) change it to multi-axis code.
@@ -29,6 +29,7 @@ class PIGCSMotorController : public PIGCSController
 public:
 	PIGCSMotorController(PIInterface* pInterface, const char* szIDN)
 	: PIGCSController(pInterface, szIDN)
+	, m_bStatusCached(false)
 	{
 	}
 	~PIGCSMotorController() {}
@@ -40,6 +41,7 @@ public:
 	virtual asynStatus referenceVelCts( PIasynAxis* pAxis, double velocity, int forwards);
     virtual asynStatus getResolution(PIasynAxis* pAxis, double& resolution );
     virtual asynStatus getStatus(PIasynAxis* pAxis, int& homing, int& moving, int& negLimit, int& posLimit, int& servoControl);
+    virtual asynStatus beginPollCycle( asynMotorAxis** Axes, int numAxes );
 
 protected:
     enum
@@ -54,7 +56,8 @@ protected:
     };
 
 private:
-
+    bool m_bStatusCached;		///< if \b TRUE m_szStatus holds the reply to #4 of this poll cycle
+    char m_szStatus[255];
 };
 
 #endif /* PIGCSMOTORCONTROLLER_H_ */
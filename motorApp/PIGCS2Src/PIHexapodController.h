@@ -52,6 +52,7 @@ public:
 
     virtual bool AcceptsNewTarget() { return !m_bAnyAxisMoving; }
     virtual bool CanCommunicateWhileHoming() { return false; }
+    virtual bool CanBatchAxisQueries() { return false; }
 
 	virtual asynStatus moveCts( PIasynAxis* pAxis, int target);
 	virtual asynStatus moveCts( PIasynAxis** pAxesArray, int* pTargetCtsArray, int numAxes);
@@ -57,6 +57,8 @@ PIasynAxis::PIasynAxis(PIasynController *pController, PIGCSController* pGCSContr
 , m_bProblem(false)
 , m_bServoControl(false)
 , m_bMoving(false)
+, m_bPositionCached(false)
+, m_cachedPosition(0.0)
 , m_pGCSController(pGCSController)
 {
       if (szName != NULL)
@@ -68,6 +68,9 @@ public:
     bool m_bMoving;
     int m_movingStateMask;
 
+    bool m_bPositionCached;		///< if \b TRUE m_cachedPosition was read in the current poll cycle
+    double m_cachedPosition;	///< position read by PIGCSController::beginPollCycle()
+
     friend class PIasynController;
 private:
 
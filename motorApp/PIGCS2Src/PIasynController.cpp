@@ -497,6 +497,18 @@ asynStatus PIasynController::poll()
     return asynSuccess;
 }
 
+/** Polls the axes of this poll cycle.
+  * The positions and the controller-wide status of all these axes are read with as few
+  * queries as possible (see PIGCSController::beginPollCycle()); PIasynAxis::poll() then
+  * uses the cached replies. */
+asynStatus PIasynController::pollAll(asynMotorAxis **pAxes, int numAxes, bool *moving)
+{
+    m_pGCSController->beginPollCycle(pAxes, numAxes);
+    asynStatus status = asynMotorController::pollAll(pAxes, numAxes, moving);
+    m_pGCSController->endPollCycle();
+    return status;
+}
+
 
 /** Configuration command, called directly or from iocsh */
 extern "C" int PI_GCS2_CreateController(const char *portName, const char* asynPort, int numAxes, int priority, int stackSize, int movingPollingRate, int idlePollingRate)
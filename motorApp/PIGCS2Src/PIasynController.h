@@ -38,6 +38,7 @@ public:
     PIasynAxis* getPIAxis(int axisNo) { return (PIasynAxis*)asynMotorController::getAxis(axisNo); }
 
     virtual asynStatus poll();
+    virtual asynStatus pollAll(asynMotorAxis **pAxes, int numAxes, bool *moving);
 
     friend class PIasynAxis;
 
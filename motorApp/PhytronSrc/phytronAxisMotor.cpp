@@ -519,6 +519,128 @@ phytronStatus phytronController::sendPhytronCommand(const char *command, char *r
 
 }
 
+/** Sends several commands to the controller with a single write and reads all the responses.
+ * Each command is sent in its own telegram, so every response carries its own ACK/NAK;
+ * the telegrams are written back to back and the responses are read as they arrive,
+ * which costs one round trip instead of one per command.
+ * \param[in]  commands  Commands without the telegram framing
+ * \param[out] responses Response data of each command, empty if the command failed
+ * \param[out] statuses  Status of each command
+ * \return The first error that occurred, phytronSuccess if all commands succeeded
+ */
+phytronStatus phytronController::sendPhytronCommands(const vector<string> &commands, vector<string> &responses,
+                                                     vector<phytronStatus> &statuses)
+{
+    string frames;
+    char buffer[MAX_CONTROLLER_STRING_SIZE];
+    size_t i, nwrite, nread, nreplies = 0;
+    int eomReason;
+    asynStatus status;
+    phytronStatus phyStatus = phytronSuccess;
+    static const char *functionName = "phytronController::sendPhytronCommands";
+
+    responses.assign(commands.size(), string());
+    statuses.assign(commands.size(), phytronSuccess);
+    if (commands.empty()) return phytronSuccess;
+
+    for (i = 0; i < commands.size(); i++) {
+        frames += (char) 0x02;                            //STX
+        frames += '0';                                    //Module address
+        frames += commands[i];                            //Command
+        frames += (char) 0x3a;                            //Separator
+        frames += "XX";                                   //XX disables checksum
+        frames += (char) 0x03;                            //ETX
+    }
+
+    pasynOctetSyncIO->flush(pasynUserController_);
+    status = pasynOctetSyncIO->write(pasynUserController_, frames.data(), frames.size(), timeout_, &nwrite);
+    if (status) {
+        statuses.assign(commands.size(), (phytronStatus) status);
+        return (phytronStatus) status;
+    }
+
+    /* Collect the responses; each ends with ETX, which the port removes if it is the input EOS */
+    string replies;
+    while (nreplies < commands.size()) {
+        status = pasynOctetSyncIO->read(pasynUserController_, buffer, sizeof(buffer), timeout_, &nread, &eomReason);
+        if (status) break;
+        replies.append(buffer, nread);
+        if (eomReason & ASYN_EOM_EOS) replies += (char) 0x03;
+        nreplies = count(replies.begin(), replies.end(), (char) 0x03);
+    }
+
+    size_t start = 0;
+    for (i = 0; i < commands.size(); i++) {
+        size_t end = replies.find((char) 0x03, start);
+        size_t stx = replies.find((char) 0x02, start);
+        if (end == string::npos || stx == string::npos || stx > end || stx + 1 >= end) {
+            //Missing or malformed response
+            statuses[i] = status ? (phytronStatus) status : phytronInvalidReturn;
+        } else if (replies[stx + 1] == 0x06) {
+            //ACK, extract response up to the separator
+            size_t separator = replies.find((char) 0x3a, stx + 2);
+            if (separator == string::npos || separator > end) separator = end;
+            responses[i] = replies.substr(stx + 2, separator - stx - 2);
+        } else {
+            //NAK
+            statuses[i] = phytronInvalidCommand;
+        }
+        if (statuses[i] && !phyStatus) {
+            phyStatus = statuses[i];
+            asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+              "%s: Command %s failed with status %d\n",
+              functionName, commands[i].c_str(), statuses[i]);
+        }
+        if (end == string::npos) {
+            //No more complete responses
+            for (i++; i < commands.size(); i++) statuses[i] = statuses[i-1];
+            break;
+        }
+        start = end + 1;
+    }
+
+    return phyStatus;
+}
+
+/** Polls a set of axes.
+ * The status commands of up to PHYTRON_POLL_AXES_PER_WRITE axes are sent with one call to
+ * sendPhytronCommands() and every axis then parses its part of the responses.
+ * \param[in] pAxes Array of pointers to the axes to poll; entries may be NULL
+ * \param[in] numAxes Number of entries in pAxes
+ * \param[out] moving Moving flag of each axis
+ */
+asynStatus phytronController::pollAll(asynMotorAxis **pAxes, int numAxes, bool *moving)
+{
+  vector<string> commands, responses;
+  vector<phytronStatus> statuses;
+  asynStatus status = asynSuccess;
+  int first = 0;
+
+  while (first < numAxes) {
+    vector<int> polled;
+    int i;
+
+    commands.clear();
+    for (i = first; i < numAxes && (int) polled.size() < PHYTRON_POLL_AXES_PER_WRITE; i++) {
+      moving[i] = false;
+      if (!pAxes[i]) continue;
+      static_cast<phytronAxis*>(pAxes[i])->appendPollCommands(commands);
+      polled.push_back(i);
+    }
+    first = i;
+
+    sendPhytronCommands(commands, responses, statuses);
+    for (i = 0; i < (int) polled.size(); i++) {
+      int index = polled[i];
+      if (static_cast<phytronAxis*>(pAxes[index])->parsePollResponses(responses, statuses,
+                                             i*PHYTRON_POLL_COMMANDS, &moving[index]) != asynSuccess)
+        status = asynError;
+    }
+  }
+
+  return status;
+}
+
 /** Castst phytronStatus to asynStatus enumeration
  * \param[in] phyStatus
  */
@@ -908,37 +1030,65 @@ asynStatus phytronAxis::setPosition(double position)
   * \param[out] moving A flag that is set indicating that the axis is moving (true) or done (false).
   */
 asynStatus phytronAxis::poll(bool *moving)
+{
+  vector<string> commands, responses;
+  vector<phytronStatus> statuses;
+
+  appendPollCommands(commands);
+  pC_->sendPhytronCommands(commands, responses, statuses);
+  return parsePollResponses(responses, statuses, 0, moving);
+}
+
+/** Appends the PHYTRON_POLL_COMMANDS commands read by poll: motor position,
+  * encoder value, moving status and axis status.
+  * \param[out] commands Command list to which the commands are appended
+  */
+void phytronAxis::appendPollCommands(vector<string> &commands)
+{
+  char command[32];
+  static const char *suffixes[PHYTRON_POLL_COMMANDS] = {"P20R", "P22R", "==H", "SE"};
+
+  for (int i = 0; i < PHYTRON_POLL_COMMANDS; i++) {
+    sprintf(command, "M%.1f%s", axisModuleNo_, suffixes[i]);
+    commands.push_back(command);
+  }
+}
+
+/** Sets the axis parameters from the responses to the commands of appendPollCommands().
+  * \param[in] responses Responses of sendPhytronCommands()
+  * \param[in] statuses Statuses of sendPhytronCommands()
+  * \param[in] first Index of this axis' first response
+  * \param[out] moving A flag that is set indicating that the axis is moving (true) or done (false).
+  */
+asynStatus phytronAxis::parsePollResponses(const vector<string> &responses, const vector<phytronStatus> &statuses,
+                                           size_t first, bool *moving)
 {
   int axisStatus;
   double position;
   double encoderPosition;
   double encoderRatio;
-  phytronStatus phyStatus;
-
-  // Read the current motor position
-  sprintf(pC_->outString_, "M%.1fP20R", axisModuleNo_);
-  phyStatus = pC_->sendPhytronCommand(pC_->outString_, pC_->inString_, MAX_CONTROLLER_STRING_SIZE, &this->response_len);
-  if(phyStatus){
-    setIntegerParam(pC_->motorStatusProblem_, 1);
-    callParamCallbacks();
-    asynPrint(pC_->pasynUserSelf, ASYN_TRACE_ERROR,
-             "phytronAxis::poll: Reading axis position failed for axis: %d!\n", axisNo_);
-    return pC_->phyToAsyn(phyStatus);
+  static const char *errors[PHYTRON_POLL_COMMANDS] = {"Reading axis position failed",
+                                                     "Reading encoder value failed",
+                                                     "Reading axis moving status failed",
+                                                     "Reading axis status failed"};
+
+  for (int i = 0; i < PHYTRON_POLL_COMMANDS; i++) {
+    if (first + i >= statuses.size() || statuses[first + i]) {
+      phytronStatus phyStatus = (first + i < statuses.size()) ? statuses[first + i] : phytronInvalidReturn;
+      setIntegerParam(pC_->motorStatusProblem_, 1);
+      callParamCallbacks();
+      asynPrint(pC_->pasynUserSelf, ASYN_TRACE_ERROR,
+               "phytronAxis::poll: %s for axis: %d!\n", errors[i], axisNo_);
+      return pC_->phyToAsyn(phyStatus);
+    }
   }
-  position = atof(pC_->inString_);
+
+  // Current motor position
+  position = atof(responses[first].c_str());
   setDoubleParam(pC_->motorPosition_, position);
 
-  // Read the current encoder value
-  sprintf(pC_->outString_, "M%.1fP22R", axisModuleNo_);
-  phyStatus = pC_->sendPhytronCommand(pC_->outString_, pC_->inString_, MAX_CONTROLLER_STRING_SIZE, &this->response_len);
-  if(phyStatus){
-    setIntegerParam(pC_->motorStatusProblem_, 1);
-    callParamCallbacks();
-    asynPrint(pC_->pasynUserSelf, ASYN_TRACE_ERROR,
-             "phytronAxis::poll: Reading encoder value failed for axis: %d!\n", axisNo_);
-    return pC_->phyToAsyn(phyStatus);
-  }
-  encoderPosition = atof(pC_->inString_);
+  // Current encoder value
+  encoderPosition = atof(responses[first + 1].c_str());
 
   /*
    * The encoder position returned by the controller is weighted by the controller
@@ -948,29 +1098,12 @@ asynStatus phytronAxis::poll(bool *moving)
   pC_->getDoubleParam(axisNo_, pC_->motorEncoderRatio_, &encoderRatio);
   setDoubleParam(pC_->motorEncoderPosition_, encoderPosition*encoderRatio);
 
-  // Read the moving status of this motor
-  sprintf(pC_->outString_, "M%.1f==H", axisModuleNo_);
-  phyStatus = pC_->sendPhytronCommand(pC_->outString_, pC_->inString_, MAX_CONTROLLER_STRING_SIZE, &this->response_len);
-  if(phyStatus){
-    setIntegerParam(pC_->motorStatusProblem_, 1);
-    callParamCallbacks();
-    asynPrint(pC_->pasynUserSelf, ASYN_TRACE_ERROR,
-              "phytronAxis::poll: Reading axis moving status failed for axis: %d!\n", axisNo_);
-    return pC_->phyToAsyn(phyStatus);
-  }
-  *moving = (pC_->inString_[0] == 'E') ? 0:1;
+  // Moving status of this motor
+  *moving = (responses[first + 2].c_str()[0] == 'E') ? 0:1;
   setIntegerParam(pC_->motorStatusDone_, !*moving);
 
-  sprintf(pC_->outString_, "M%.1fSE", axisModuleNo_);
-  phyStatus = pC_->sendPhytronCommand(pC_->outString_, pC_->inString_, MAX_CONTROLLER_STRING_SIZE, &this->response_len);
-  if(phyStatus){
-    setIntegerParam(pC_->motorStatusProblem_, 1);
-    callParamCallbacks();
-    asynPrint(pC_->pasynUserSelf, ASYN_TRACE_ERROR,
-             "phytronAxis::poll: Reading axis status failed for axis: %d!\n", axisNo_);
-    return pC_->phyToAsyn(phyStatus);
-  }
-  axisStatus = atoi(pC_->inString_);
+  // Axis status
+  axisStatus = atoi(responses[first + 3].c_str());
   setIntegerParam(pC_->motorStatusHighLimit_, (axisStatus & 0x10)/0x10);
   setIntegerParam(pC_->motorStatusLowLimit_, (axisStatus & 0x20)/0x20);
   setIntegerParam(pC_->motorStatusAtHome_, (axisStatus & 0x40)/0x40);
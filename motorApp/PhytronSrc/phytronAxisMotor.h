@@ -7,6 +7,9 @@ Cosylab d.d. 2014
 
 */
 
+#include <string>
+#include <vector>
+
 #include "asynMotorController.h"
 #include "asynMotorAxis.h"
 
@@ -20,6 +23,10 @@ Cosylab d.d. 2014
 #define MAX_ACCELERATION  500000  // steps/s^2
 #define MIN_ACCELERATION  4000    // steps/s^2
 
+//Number of telegrams sent per axis by poll, and maximum number of axes polled with one write
+#define PHYTRON_POLL_COMMANDS       4
+#define PHYTRON_POLL_AXES_PER_WRITE 8
+
 //Controller parameters
 #define controllerStatusString      "CONTROLLER_STATUS"
 #define controllerStatusResetString "CONTROLLER_STATUS_RESET"
@@ -94,6 +101,10 @@ public:
   asynStatus poll(bool *moving);
   asynStatus setPosition(double position);
 
+  void appendPollCommands(std::vector<std::string> &commands);
+  asynStatus parsePollResponses(const std::vector<std::string> &responses,
+                                const std::vector<phytronStatus> &statuses, size_t first, bool *moving);
+
   asynStatus setEncoderRatio(double ratio);
   asynStatus setEncoderPosition(double position);
 
@@ -123,6 +134,9 @@ public:
   phytronAxis* getAxis(int axisNo);
 
   phytronStatus sendPhytronCommand(const char *command, char *response_buffer, size_t response_max_len, size_t *nread);
+  phytronStatus sendPhytronCommands(const std::vector<std::string> &commands, std::vector<std::string> &responses,
+                                    std::vector<phytronStatus> &statuses);
+  asynStatus pollAll(asynMotorAxis **pAxes, int numAxes, bool *moving);
 
   void resetAxisEncoderRatio();
 